@@ -0,0 +1,311 @@
+/*
+
+	This file is part of the Malbolge disassembler.
+	Copyright (C) 2016 Matthias Lutter
+
+	The Malbolge disassembler is free software: you can redistribute it
+	and/or modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation, either version 3 of
+	the License, or (at your option) any later version.
+
+	The Malbolge disassembler is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+	of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	E-Mail: matthias@lutter.cc
+
+
+
+	For more Malbolge stuff, please visit
+	<https://lutter.cc/>
+
+*/
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+#define WINDOWS
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+
+// checkpoints of the transcript analysis. a checkpoint file contains in this order:
+//   "MDCP", CHECKPOINT_VERSION, sizeof(VMState) and the key of the Malbolge program and the input files,
+//   the number of steps to the entry point and the entry state,
+//   the AccessAnalysis: decision of the A register, maximal_steps_from_entry_point, coverage, truncation, flags and edges,
+//   the runs that have not been finished yet: node of the transcript trie, fed, continuation, hash and length of the
+//   output and state.
+// numbers are written in the byte order of the machine; a checkpoint is only read by the disassembler that has written it.
+// the file is replaced atomically, so a killed disassembler leaves the previous checkpoint.
+
+#define CHECKPOINT_MAGIC "MDCP"
+#define CHECKPOINT_VERSION 3
+
+int hash_file(const char* filename, unsigned long long* hash);
+int write_checkpoint_data(FILE* file, const void* data, size_t length);
+int read_checkpoint_data(FILE* file, void* data, size_t length);
+int write_checkpoint_edges(FILE* file, const struct AccessAnalysis* accesses);
+
+// continues the FNV-1a hash with the length and the contents of the file. returns 1 if it cannot be read.
+int hash_file(const char* filename, unsigned long long* hash) {
+	unsigned char data[4096];
+	unsigned long long length = 0;
+	size_t read;
+	size_t i;
+	FILE* file = fopen(filename, "rb");
+	if (!file) {
+		return 1;
+	}
+	while ((read = fread(data, 1, sizeof(data), file)) > 0) {
+		for (i=0;i<read;i++) {
+			*hash ^= data[i];
+			*hash *= 0x100000001b3ULL;
+		}
+		length += read;
+	}
+	if (ferror(file)) {
+		fclose(file);
+		return 1;
+	}
+	fclose(file);
+	// files of different lengths must not be confused when they are hashed one after another
+	for (i=0;i<sizeof(length);i++) {
+		*hash ^= (length >> (8*i)) & 0xff;
+		*hash *= 0x100000001b3ULL;
+	}
+	return 0;
+}
+
+int checkpoint_key(const char* malbolge_file, char** user_input_files, unsigned long long* key) {
+	int i;
+	*key = 0xcbf29ce484222325ULL;
+	if (hash_file(malbolge_file, key)) {
+		return 1;
+	}
+	for (i=0;user_input_files && user_input_files[i];i++) {
+		if (hash_file(user_input_files[i], key)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+int write_checkpoint_data(FILE* file, const void* data, size_t length) {
+	return fwrite(data, 1, length, file) != length;
+}
+
+int read_checkpoint_data(FILE* file, void* data, size_t length) {
+	return fread(data, 1, length, file) != length;
+}
+
+// writes the number of edges and the edges as kind << 32 | cell << 16 | target, like the edge log.
+// the predecessors are not written; they are added again with the successors.
+int write_checkpoint_edges(FILE* file, const struct AccessAnalysis* accesses) {
+	const int kinds[3] = {FLOW_SUCCESSORS, FLOW_JMP_DESTINATIONS, FLOW_MOVD_DESTINATIONS};
+	const int edge_kinds[3] = {EDGE_NORMAL_FLOW, EDGE_JMP, EDGE_MOVD};
+	unsigned long long number_of_edges = 0;
+	int failed = 0;
+	int pass, i, j, k;
+	for (pass=0;pass<2;pass++) {
+		if (pass == 1) {
+			failed |= write_checkpoint_data(file, &number_of_edges, sizeof(number_of_edges));
+		}
+		for (i=0;i<EDGE_SET_PAGES && !failed;i++) {
+			struct EdgeSetPage* page = accesses->edge_sets[i];
+			if (!page) {
+				continue;
+			}
+			for (j=0;j<EDGE_SET_PAGE_CELLS;j++) {
+				for (k=0;k<3;k++) {
+					struct avl_table* set = *edge_set_of_kind(&page->cells[j], kinds[k]);
+					struct avl_traverser it;
+					int* target;
+					if (!set) {
+						continue;
+					}
+					if (pass == 0) {
+						number_of_edges += set->avl_count;
+						continue;
+					}
+					for (target=(int*)avl_t_first(&it, set);target;target=(int*)avl_t_next(&it)) {
+						unsigned long long edge = ((unsigned long long)edge_kinds[k] << 32) |
+								((unsigned long long)(i*EDGE_SET_PAGE_CELLS + j) << 16) | (unsigned long long)*target;
+						failed |= write_checkpoint_data(file, &edge, sizeof(edge));
+					}
+				}
+			}
+		}
+	}
+	return failed;
+}
+
+int write_checkpoint(struct Checkpoint* checkpoint, struct AccessAnalysis* accesses, const struct TranscriptBranch* runs, int number_of_runs) {
+	char* temporary = 0;
+	FILE* file = 0;
+	int version = CHECKPOINT_VERSION;
+	int state_size = sizeof(struct VMState);
+	int failed = 0;
+	int i;
+
+	temporary = (char*)malloc(strlen(checkpoint->filename)+5);
+	if (!temporary) {
+		return 1;
+	}
+	strcpy(temporary, checkpoint->filename);
+	strcat(temporary, ".tmp");
+	file = fopen(temporary, "wb");
+	if (!file) {
+		free(temporary);
+		return 1;
+	}
+	flush_edge_log(accesses);
+	failed |= write_checkpoint_data(file, CHECKPOINT_MAGIC, 4);
+	failed |= write_checkpoint_data(file, &version, sizeof(version));
+	failed |= write_checkpoint_data(file, &state_size, sizeof(state_size));
+	failed |= write_checkpoint_data(file, &checkpoint->key, sizeof(checkpoint->key));
+	failed |= write_checkpoint_data(file, &checkpoint->steps_to_entrypoint, sizeof(checkpoint->steps_to_entrypoint));
+	failed |= write_checkpoint_data(file, checkpoint->entry_state, sizeof(struct VMState));
+
+	failed |= write_checkpoint_data(file, &accesses->a_register_matters, sizeof(accesses->a_register_matters));
+	failed |= write_checkpoint_data(file, &accesses->a_register_decided, sizeof(accesses->a_register_decided));
+	failed |= write_checkpoint_data(file, &accesses->maximal_steps_from_entry_point, sizeof(accesses->maximal_steps_from_entry_point));
+	failed |= write_checkpoint_data(file, &accesses->coverage, sizeof(accesses->coverage));
+	failed |= write_checkpoint_data(file, &accesses->coverage_truncated, sizeof(accesses->coverage_truncated));
+	failed |= write_checkpoint_data(file, accesses->access, sizeof(accesses->access));
+	failed |= write_checkpoint_edges(file, accesses);
+
+	failed |= write_checkpoint_data(file, &number_of_runs, sizeof(number_of_runs));
+	for (i=0;i<number_of_runs && !failed;i++) {
+		failed |= write_checkpoint_data(file, &runs[i].node, sizeof(runs[i].node));
+		failed |= write_checkpoint_data(file, &runs[i].fed, sizeof(runs[i].fed));
+		failed |= write_checkpoint_data(file, &runs[i].continuation.steps, sizeof(runs[i].continuation.steps));
+		failed |= write_checkpoint_data(file, &runs[i].continuation.last_accessed_d_pos, sizeof(runs[i].continuation.last_accessed_d_pos));
+		failed |= write_checkpoint_data(file, &runs[i].output_hash, sizeof(runs[i].output_hash));
+		failed |= write_checkpoint_data(file, &runs[i].output_length, sizeof(runs[i].output_length));
+		failed |= write_checkpoint_data(file, runs[i].state, sizeof(struct VMState));
+	}
+	if (fclose(file) != 0) {
+		failed = 1;
+	}
+#ifdef WINDOWS
+	if (!failed) {
+		remove(checkpoint->filename); // rename does not replace files
+	}
+#endif
+	if (failed || rename(temporary, checkpoint->filename) != 0) {
+		remove(temporary);
+		free(temporary);
+		return 1;
+	}
+	free(temporary);
+	return 0;
+}
+
+// returns 0 if the checkpoint has been loaded, 1 if there is no checkpoint file and 2 if the file is invalid or
+// belongs to another Malbolge program or other input files. accesses->error is set if there is not enough memory.
+int load_checkpoint(struct Checkpoint* checkpoint, struct VMState* entry_state, struct AccessAnalysis* accesses) {
+	FILE* file = 0;
+	char magic[4];
+	int version = 0;
+	int state_size = 0;
+	unsigned long long key = 0;
+	unsigned long long number_of_edges = 0;
+	unsigned long long i;
+	unsigned int coverage = 0;
+	int number_of_runs = 0;
+	int invalid = 0;
+	int j;
+
+	file = fopen(checkpoint->filename, "rb");
+	if (!file) {
+		return 1;
+	}
+	if (read_checkpoint_data(file, magic, 4) || memcmp(magic, CHECKPOINT_MAGIC, 4) != 0 ||
+			read_checkpoint_data(file, &version, sizeof(version)) || version != CHECKPOINT_VERSION ||
+			read_checkpoint_data(file, &state_size, sizeof(state_size)) || state_size != sizeof(struct VMState) ||
+			read_checkpoint_data(file, &key, sizeof(key)) || key != checkpoint->key) {
+		fclose(file);
+		return 2;
+	}
+	reset_access_analysis(accesses);
+	invalid |= read_checkpoint_data(file, &checkpoint->steps_to_entrypoint, sizeof(checkpoint->steps_to_entrypoint));
+	invalid |= read_checkpoint_data(file, entry_state, sizeof(struct VMState));
+	invalid |= read_checkpoint_data(file, &accesses->a_register_matters, sizeof(accesses->a_register_matters));
+	invalid |= read_checkpoint_data(file, &accesses->a_register_decided, sizeof(accesses->a_register_decided));
+	invalid |= read_checkpoint_data(file, &accesses->maximal_steps_from_entry_point, sizeof(accesses->maximal_steps_from_entry_point));
+	invalid |= read_checkpoint_data(file, &coverage, sizeof(coverage));
+	invalid |= read_checkpoint_data(file, &accesses->coverage_truncated, sizeof(accesses->coverage_truncated));
+	invalid |= read_checkpoint_data(file, accesses->access, sizeof(accesses->access));
+	invalid |= read_checkpoint_data(file, &number_of_edges, sizeof(number_of_edges));
+	for (i=0;i<number_of_edges && !invalid && !accesses->error;i++) {
+		unsigned long long edge = 0;
+		invalid |= read_checkpoint_data(file, &edge, sizeof(edge));
+		if ((edge >> 32) > 2 || ((edge >> 16) & 0xffff) >= 59049 || (edge & 0xffff) >= 59049) {
+			invalid = 1;
+		}
+		if (!invalid) {
+			apply_edge(accesses, edge);
+		}
+	}
+	// the coverage is counted again by apply_edge; the stored number includes the flags
+	accesses->coverage = coverage;
+	// the deadline of the coverage limits starts again
+	accesses->coverage_truncated &= ~DEADLINE_REACHED;
+
+	invalid |= read_checkpoint_data(file, &number_of_runs, sizeof(number_of_runs));
+	if (!invalid && !accesses->error && number_of_runs > 0) {
+		checkpoint->runs = (struct TranscriptBranch*)calloc(number_of_runs, sizeof(struct TranscriptBranch));
+		if (!checkpoint->runs) {
+			accesses->error = MD_ERROR_MEMORY;
+		}
+	}
+	for (j=0;j<number_of_runs && !invalid && !accesses->error;j++) {
+		struct TranscriptBranch* run = &checkpoint->runs[j];
+		run->state = (struct VMState*)malloc(sizeof(struct VMState));
+		if (!run->state) {
+			accesses->error = MD_ERROR_MEMORY;
+			break;
+		}
+		checkpoint->number_of_runs++;
+		invalid |= read_checkpoint_data(file, &run->node, sizeof(run->node));
+		invalid |= read_checkpoint_data(file, &run->fed, sizeof(run->fed));
+		invalid |= read_checkpoint_data(file, &run->continuation.steps, sizeof(run->continuation.steps));
+		invalid |= read_checkpoint_data(file, &run->continuation.last_accessed_d_pos, sizeof(run->continuation.last_accessed_d_pos));
+		invalid |= read_checkpoint_data(file, &run->output_hash, sizeof(run->output_hash));
+		invalid |= read_checkpoint_data(file, &run->output_length, sizeof(run->output_length));
+		invalid |= read_checkpoint_data(file, run->state, sizeof(struct VMState));
+		if (!invalid && (run->node < 0 || run->state->c < 0 || run->state->c >= 59049 || run->state->d < 0 || run->state->d >= 59049)) {
+			invalid = 1;
+		}
+	}
+	fclose(file);
+	if (invalid || accesses->error || number_of_runs < 0) {
+		int error = accesses->error;
+		free_checkpoint_runs(checkpoint);
+		reset_access_analysis(accesses);
+		accesses->error = error;
+		return 2;
+	}
+	return 0;
+}
+
+void remove_checkpoint(struct Checkpoint* checkpoint) {
+	remove(checkpoint->filename);
+}
+
+void free_checkpoint_runs(struct Checkpoint* checkpoint) {
+	int i;
+	for (i=0;i<checkpoint->number_of_runs;i++) {
+		free(checkpoint->runs[i].state);
+	}
+	if (checkpoint->runs) {
+		free(checkpoint->runs);
+	}
+	checkpoint->runs = 0;
+	checkpoint->number_of_runs = 0;
+}
@@ -0,0 +1,291 @@
+/*
+
+	This file is part of the Malbolge disassembler.
+	Copyright (C) 2016 Matthias Lutter
+
+	The Malbolge disassembler is free software: you can redistribute it
+	and/or modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation, either version 3 of
+	the License, or (at your option) any later version.
+
+	The Malbolge disassembler is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+	of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	E-Mail: matthias@lutter.cc
+
+
+
+	For more Malbolge stuff, please visit
+	<https://lutter.cc/>
+
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+
+// coverage features of the input files and the minimization of a set of input files.
+// the features of an input file are found by an analysis of this file alone. the analysis of several input files
+// finds the union of their features, so the smallest set of input files with the same union gives the same analysis.
+
+int compare_features(const void* a, const void* b);
+int compare_attribution_pairs(const void* a, const void* b);
+long find_feature(const struct CoverageAttribution* attribution, unsigned long long feature);
+
+// the access flags that are found by the runs; FIXED_OFFSET is derived from the flags and the edges of several runs
+static const int FEATURE_FLAGS = 0x0f0f;
+
+int compare_features(const void* a, const void* b) {
+	unsigned long long x = *(const unsigned long long*)a;
+	unsigned long long y = *(const unsigned long long*)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// pairs of a feature and an input: by feature, then by input
+int compare_attribution_pairs(const void* a, const void* b) {
+	const unsigned long long* x = (const unsigned long long*)a;
+	const unsigned long long* y = (const unsigned long long*)b;
+	if (x[0] != y[0]) {
+		return x[0] < y[0] ? -1 : 1;
+	}
+	return x[1] < y[1] ? -1 : (x[1] > y[1] ? 1 : 0);
+}
+
+// collects the access flags and the edges of the analysis, sorted. the predecessors are left out; they mirror the
+// successors. returns 1 if out of memory.
+int collect_coverage_features(struct AccessAnalysis* accesses, struct CoverageFeatures* features) {
+	const int kinds[3] = {FLOW_SUCCESSORS, FLOW_JMP_DESTINATIONS, FLOW_MOVD_DESTINATIONS};
+	const int edge_kinds[3] = {EDGE_NORMAL_FLOW, EDGE_JMP, EDGE_MOVD};
+	size_t length = 0;
+	int pass, i, j, k;
+	memset(features, 0, sizeof(struct CoverageFeatures));
+	flush_edge_log(accesses);
+	for (pass=0;pass<2;pass++) {
+		if (pass == 1) {
+			features->features = (unsigned long long*)malloc(sizeof(unsigned long long)*(length>0?length:1));
+			if (!features->features) {
+				return 1;
+			}
+		}
+		// edges, in the order of the encoding
+		for (i=0;i<EDGE_SET_PAGES;i++) {
+			struct EdgeSetPage* page = accesses->edge_sets[i];
+			if (!page) {
+				continue;
+			}
+			for (j=0;j<EDGE_SET_PAGE_CELLS;j++) {
+				for (k=0;k<3;k++) {
+					struct avl_table* set = *edge_set_of_kind(&page->cells[j], kinds[k]);
+					struct avl_traverser it;
+					int* target;
+					if (!set) {
+						continue;
+					}
+					if (pass == 0) {
+						length += set->avl_count;
+						continue;
+					}
+					for (target=(int*)avl_t_first(&it, set);target;target=(int*)avl_t_next(&it)) {
+						features->features[features->length++] = ((unsigned long long)edge_kinds[k] << 32) |
+								((unsigned long long)(i*EDGE_SET_PAGE_CELLS + j) << 16) | (unsigned long long)*target;
+					}
+				}
+			}
+		}
+		// access flags
+		for (i=0;i<59049;i++) {
+			int flags = accesses->access[i] & FEATURE_FLAGS;
+			for (k=0;flags;k++,flags>>=1) {
+				if (!(flags & 1)) {
+					continue;
+				}
+				if (pass == 0) {
+					length++;
+				}else{
+					features->features[features->length++] = ((unsigned long long)FEATURE_ACCESS_FLAG << 32) |
+							((unsigned long long)i << 16) | (unsigned long long)(1 << k);
+				}
+			}
+		}
+	}
+	// the edge kinds interleave by cell
+	qsort(features->features, features->length, sizeof(unsigned long long), compare_features);
+	return 0;
+}
+
+void free_coverage_features(struct CoverageFeatures* features) {
+	if (features->features) {
+		free(features->features);
+	}
+	memset(features, 0, sizeof(struct CoverageFeatures));
+}
+
+// builds the attribution index of the features of the inputs. returns 1 if out of memory.
+int build_coverage_attribution(const struct CoverageFeatures* inputs, int number_of_inputs, struct CoverageAttribution* attribution) {
+	unsigned long long* pairs = 0;
+	size_t number_of_pairs = 0;
+	size_t i, p;
+	int input;
+	memset(attribution, 0, sizeof(struct CoverageAttribution));
+	for (input=0;input<number_of_inputs;input++) {
+		number_of_pairs += inputs[input].length;
+	}
+	pairs = (unsigned long long*)malloc(2*sizeof(unsigned long long)*(number_of_pairs>0?number_of_pairs:1));
+	attribution->features = (unsigned long long*)malloc(sizeof(unsigned long long)*(number_of_pairs>0?number_of_pairs:1));
+	attribution->offsets = (size_t*)malloc(sizeof(size_t)*(number_of_pairs+1));
+	attribution->inputs = (int*)malloc(sizeof(int)*(number_of_pairs>0?number_of_pairs:1));
+	if (!pairs || !attribution->features || !attribution->offsets || !attribution->inputs) {
+		if (pairs) {
+			free(pairs);
+		}
+		free_coverage_attribution(attribution);
+		return 1;
+	}
+	p = 0;
+	for (input=0;input<number_of_inputs;input++) {
+		for (i=0;i<inputs[input].length;i++) {
+			pairs[p++] = inputs[input].features[i];
+			pairs[p++] = (unsigned long long)input;
+		}
+	}
+	qsort(pairs, number_of_pairs, 2*sizeof(unsigned long long), compare_attribution_pairs);
+	for (i=0;i<number_of_pairs;i++) {
+		if (i == 0 || pairs[2*i] != pairs[2*i-2]) {
+			attribution->offsets[attribution->number_of_features] = i;
+			attribution->features[attribution->number_of_features++] = pairs[2*i];
+		}
+		attribution->inputs[i] = (int)pairs[2*i+1];
+	}
+	attribution->offsets[attribution->number_of_features] = number_of_pairs;
+	free(pairs);
+	return 0;
+}
+
+void free_coverage_attribution(struct CoverageAttribution* attribution) {
+	if (attribution->features) {
+		free(attribution->features);
+	}
+	if (attribution->offsets) {
+		free(attribution->offsets);
+	}
+	if (attribution->inputs) {
+		free(attribution->inputs);
+	}
+	memset(attribution, 0, sizeof(struct CoverageAttribution));
+}
+
+// returns the index of the feature in the attribution index or -1.
+long find_feature(const struct CoverageAttribution* attribution, unsigned long long feature) {
+	size_t low = 0;
+	size_t high = attribution->number_of_features;
+	while (low < high) {
+		size_t middle = low + (high-low)/2;
+		if (attribution->features[middle] < feature) {
+			low = middle+1;
+		}else{
+			high = middle;
+		}
+	}
+	if (low < attribution->number_of_features && attribution->features[low] == feature) {
+		return (long)low;
+	}
+	return -1;
+}
+
+// returns the number of features that are produced by this input only.
+size_t count_unique_features(const struct CoverageAttribution* attribution, const struct CoverageFeatures* input, int index) {
+	size_t unique = 0;
+	size_t i;
+	for (i=0;i<input->length;i++) {
+		long feature = find_feature(attribution, input->features[i]);
+		if (feature >= 0 && attribution->offsets[feature+1] - attribution->offsets[feature] == 1 &&
+				attribution->inputs[attribution->offsets[feature]] == index) {
+			unique++;
+		}
+	}
+	return unique;
+}
+
+// selects inputs until all features of the attribution index are produced: greedily the input that adds the most
+// features, on a tie the one with the lower cost, then the first one. selected receives the indices in the order of
+// selection and gains the number of features each of them has added. returns the number of selected inputs or -1 if out
+// of memory.
+int minimize_coverage(const struct CoverageAttribution* attribution, const struct CoverageFeatures* inputs, int number_of_inputs,
+		const size_t* costs, int* selected, size_t* gains) {
+	char* covered = 0;
+	char* taken = 0;
+	long** indices = 0;
+	size_t uncovered = attribution->number_of_features;
+	int number_of_selected = 0;
+	int input;
+	size_t i;
+
+	covered = (char*)calloc(attribution->number_of_features+1, 1);
+	taken = (char*)calloc(number_of_inputs+1, 1);
+	indices = (long**)calloc(number_of_inputs+1, sizeof(long*));
+	if (!covered || !taken || !indices) {
+		number_of_selected = -1;
+	}
+	// the features of every input as indices into the attribution index
+	for (input=0;input<number_of_inputs && number_of_selected >= 0;input++) {
+		indices[input] = (long*)malloc(sizeof(long)*(inputs[input].length>0?inputs[input].length:1));
+		if (!indices[input]) {
+			number_of_selected = -1;
+			break;
+		}
+		for (i=0;i<inputs[input].length;i++) {
+			indices[input][i] = find_feature(attribution, inputs[input].features[i]);
+		}
+	}
+	while (number_of_selected >= 0 && uncovered > 0) {
+		int best = -1;
+		size_t best_gain = 0;
+		for (input=0;input<number_of_inputs;input++) {
+			size_t gain = 0;
+			if (taken[input]) {
+				continue;
+			}
+			for (i=0;i<inputs[input].length;i++) {
+				if (!covered[indices[input][i]]) {
+					gain++;
+				}
+			}
+			if (gain > best_gain || (gain == best_gain && gain > 0 && costs[input] < costs[best])) {
+				best = input;
+				best_gain = gain;
+			}
+		}
+		if (best == -1) {
+			break;
+		}
+		taken[best] = 1;
+		for (i=0;i<inputs[best].length;i++) {
+			covered[indices[best][i]] = 1;
+		}
+		uncovered -= best_gain;
+		selected[number_of_selected] = best;
+		gains[number_of_selected] = best_gain;
+		number_of_selected++;
+	}
+	if (indices) {
+		for (input=0;input<number_of_inputs;input++) {
+			if (indices[input]) {
+				free(indices[input]);
+			}
+		}
+		free(indices);
+	}
+	if (covered) {
+		free(covered);
+	}
+	if (taken) {
+		free(taken);
+	}
+	return number_of_selected;
+}
@@ -0,0 +1,173 @@
+/*
+
+	This file is part of the Malbolge disassembler.
+	Copyright (C) 2016 Matthias Lutter
+
+	The Malbolge disassembler is free software: you can redistribute it
+	and/or modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation, either version 3 of
+	the License, or (at your option) any later version.
+
+	The Malbolge disassembler is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+	of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	E-Mail: matthias@lutter.cc
+
+
+
+	For more Malbolge stuff, please visit
+	<https://lutter.cc/>
+
+*/
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "main.h"
+
+// debug information of a HeLL file: the lines that belong to a memory cell, so a debugger or a profiler can map
+// addresses to lines of the HeLL file and back without parsing it. the file is laid out to be mapped into memory
+// and searched in place; all numbers are stored with the least significant byte first:
+//   "MDDB", DEBUG_INFO_VERSION, number of records, DEBUG_RECORD_LENGTH, 4 bytes each,
+//   the records, sorted by line:
+//     line (from 1), address, index of the block in its section, 4 bytes each,
+//     kind (DEBUG_*), section (0: .CODE, 1: .DATA), length of the xlat cycle of the cell's value (0: no valid command),
+//     a zero byte,
+//     step at which the cell has been executed first since the begin of the program (-1: never), 8 bytes,
+//   the numbers of the records, 4 bytes each, sorted by address and then by line.
+// every line has at most one record and an address may have several (its labels and its word), so a line is found by
+// binary search in the records and the lines of an address are found by binary search in the address index.
+
+#define DEBUG_INFO_MAGIC "MDDB"
+#define DEBUG_INFO_VERSION 1
+#define DEBUG_INFO_HEADER_LENGTH 16
+#define DEBUG_RECORD_LENGTH 24
+
+void put_debug_number(unsigned char* data, unsigned long long number, int length);
+int compare_debug_addresses(const void* a, const void* b);
+
+void put_debug_number(unsigned char* data, unsigned long long number, int length) {
+	int i;
+	for (i=0;i<length;i++) {
+		data[i] = (unsigned char)(number >> (8*i));
+	}
+}
+
+// address << 32 | number of the record
+int compare_debug_addresses(const void* a, const void* b) {
+	unsigned long long x = *(const unsigned long long*)a;
+	unsigned long long y = *(const unsigned long long*)b;
+	return x < y ? -1 : (x > y ? 1 : 0);
+}
+
+// appends a record behind the records of earlier lines. returns 1 if out of memory.
+int add_debug_record(struct DebugRecords* debug, long long line, int kind, int address, int xlat_cycle, long long first_executed) {
+	struct DebugRecord* record;
+	if (debug->failed) {
+		return 1;
+	}
+	if (debug->length == debug->capacity) {
+		size_t capacity = debug->capacity ? 2*debug->capacity : 256;
+		struct DebugRecord* tmp = (struct DebugRecord*)realloc(debug->records, sizeof(struct DebugRecord)*capacity);
+		if (!tmp) {
+			debug->failed = 1;
+			return 1;
+		}
+		debug->records = tmp;
+		debug->capacity = capacity;
+	}
+	record = &debug->records[debug->length++];
+	memset(record, 0, sizeof(struct DebugRecord));
+	record->line = line;
+	record->kind = kind;
+	record->address = address;
+	record->xlat_cycle = xlat_cycle;
+	record->first_executed = first_executed;
+	return 0;
+}
+
+// appends the records of a block whose lines have been numbered already. returns 1 if out of memory.
+int append_debug_records(struct DebugRecords* debug, const struct DebugRecords* block, int component, int data) {
+	size_t i;
+	if (block->failed) {
+		debug->failed = 1;
+	}
+	for (i=0;i<block->length && !debug->failed;i++) {
+		const struct DebugRecord* record = &block->records[i];
+		if (!add_debug_record(debug, record->line, record->kind, record->address, record->xlat_cycle, record->first_executed)) {
+			debug->records[debug->length-1].component = component;
+			debug->records[debug->length-1].data = data;
+		}
+	}
+	return debug->failed;
+}
+
+void free_debug_records(struct DebugRecords* debug) {
+	if (debug->records) {
+		free(debug->records);
+	}
+	memset(debug, 0, sizeof(struct DebugRecords));
+}
+
+// writes the debug information file. returns 1 if it cannot be written or memory has run out.
+int write_debug_info(const char* filename, const struct DebugRecords* debug) {
+	size_t length = DEBUG_INFO_HEADER_LENGTH + (DEBUG_RECORD_LENGTH+4)*debug->length;
+	unsigned long long* index = 0;
+	unsigned char* data = 0;
+	unsigned char* p;
+	FILE* file = 0;
+	int failed = 0;
+	size_t i;
+	if (debug->failed || debug->length > 0xffffffffUL) {
+		return 1;
+	}
+	data = (unsigned char*)calloc(length, 1);
+	index = (unsigned long long*)malloc(sizeof(unsigned long long)*(debug->length>0?debug->length:1));
+	if (!data || !index) {
+		failed = 1;
+	}
+	if (!failed) {
+		memcpy(data, DEBUG_INFO_MAGIC, 4);
+		put_debug_number(data+4, DEBUG_INFO_VERSION, 4);
+		put_debug_number(data+8, debug->length, 4);
+		put_debug_number(data+12, DEBUG_RECORD_LENGTH, 4);
+		p = data + DEBUG_INFO_HEADER_LENGTH;
+		for (i=0;i<debug->length;i++) {
+			const struct DebugRecord* record = &debug->records[i];
+			put_debug_number(p, (unsigned long long)record->line, 4);
+			put_debug_number(p+4, (unsigned long long)record->address, 4);
+			put_debug_number(p+8, (unsigned long long)record->component, 4);
+			p[12] = (unsigned char)record->kind;
+			p[13] = (unsigned char)(record->data ? 1 : 0);
+			p[14] = (unsigned char)record->xlat_cycle;
+			put_debug_number(p+16, (unsigned long long)record->first_executed, 8);
+			p += DEBUG_RECORD_LENGTH;
+			index[i] = ((unsigned long long)record->address << 32) | i;
+		}
+		// the records are sorted by line, so the numbers keep the lines of an address in order
+		qsort(index, debug->length, sizeof(unsigned long long), compare_debug_addresses);
+		for (i=0;i<debug->length;i++) {
+			put_debug_number(p, index[i] & 0xffffffffULL, 4);
+			p += 4;
+		}
+		file = fopen(filename, "wb");
+		if (!file) {
+			failed = 1;
+		}else{
+			failed = (fwrite(data, 1, length, file) != length);
+			failed |= (fclose(file) != 0);
+		}
+	}
+	if (data) {
+		free(data);
+	}
+	if (index) {
+		free(index);
+	}
+	return failed;
+}
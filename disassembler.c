@@ -0,0 +1,4907 @@
+/*
+
+	This file is part of the Malbolge disassembler.
+	Copyright (C) 2016 Matthias Lutter
+
+	The Malbolge disassembler is free software: you can redistribute it
+	and/or modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation, either version 3 of
+	the License, or (at your option) any later version.
+
+	The Malbolge disassembler is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+	of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	E-Mail: matthias@lutter.cc
+
+
+
+	For more Malbolge stuff, please visit
+	<https://lutter.cc/>
+
+*/
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+#define WINDOWS
+#endif
+#if defined(__x86_64__) && !defined(WINDOWS)
+#define JIT_X86_64
+#endif
+
+#include <signal.h>
+#include <stdlib.h>
+#include <stdio.h>
+#ifndef WINDOWS
+#include <unistd.h>
+#else
+#include <windows.h>
+#endif
+#include <string.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <time.h>
+#ifndef WINDOWS
+#include <sys/mman.h>
+#include <pthread.h>
+#endif
+
+#include "main.h"
+
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+// there is no state shared by several disassemble calls, except for the tables below, which are initialized once and
+// only read afterwards.
+// the Disassembler of the disassemble call running in this thread; execute checks its interrupt flag
+static THREAD_LOCAL struct Disassembler* current_disassembler = 0;
+// the Disassembler that is interrupted by CTRL+C
+static struct Disassembler* volatile sigint_disassembler = 0;
+#ifndef WINDOWS
+static pthread_once_t tables_initialized = PTHREAD_ONCE_INIT;
+#else
+static INIT_ONCE tables_initialized = INIT_ONCE_STATIC_INIT;
+#endif
+const char* translation = "5z]&gqtyfr$(we4{WP)H-Zn,[%\\3dL+Q;>U!pJS72FhOA1CB6v^=I_0/8|jsb9m<.TVac`uY*MK'X~xDl}REokN:#?G\"i@";
+// decoded commands and xlat cycles for values 33..126, indexed by [value-33][position%94]
+unsigned char instruction_table[94][94];
+struct XlatCycleInfo xlat_cycle_table[94][94];
+const char* instruction_names[94];
+unsigned short trit_planes_of_5[243]; // bits 0-4: trits that are 1, bits 5-9: trits that are 2
+unsigned char value_of_5_trits[32][32]; // indexed by both planes of 5 trits
+void init_tables();
+void report_progress(struct Disassembler* disassembler, const char* format, ...);
+int report_error(struct Disassembler* disassembler, int error, const char* format, ...);
+int install_sigint_handler(struct Disassembler* disassembler, struct SigintHandler* handler);
+void restore_sigint_handler(struct SigintHandler* handler);
+void describe_exhausted_budget(char* text, size_t size, int exhausted);
+int poll_execution(struct ExecutionContext* context);
+int checkpoint_due();
+int run_disassembler(struct Disassembler* disassembler, const char* malbolge_file, const char* output_filename, struct VMState* initial_state,
+		struct VMState* entry_state, struct AccessAnalysis* accesses, struct FlowGraph* graph, struct ConnectedMemoryCells** creg_components,
+		struct ConnectedMemoryCells** dreg_components, struct EventTrace* pre_entry_events);
+int run_engine_check(struct Disassembler* disassembler, const char* malbolge_file, long long interval, struct VMState* initial_state,
+		struct VMState* agreed_state, struct LockstepEngine* engines, int number_of_engines);
+long long run_lockstep_engine(struct LockstepEngine* engine, const struct UserInput* input, long long steps, int* interrupted);
+int lockstep_diverged(const struct LockstepEngine* reference, const struct LockstepEngine* engine);
+void report_break(struct Disassembler* disassembler, const struct VMState* state, const struct BreakCondition* break_on, long long steps,
+		int interrupted);
+int locate_divergence(struct Disassembler* disassembler, struct LockstepEngine* reference, struct LockstepEngine* engine,
+		const struct VMState* agreed_state, size_t input_pos, const struct UserInput* input, long long start_step, long long steps);
+void free_codeblocks(struct ConnectedMemoryCells* components);
+unsigned int crazy(unsigned int a, unsigned int d);
+unsigned int crazy_digits(unsigned int a, unsigned int d);
+int compare_crazy_row(struct CrazyCheck* check, int row);
+#ifndef WINDOWS
+void* crazy_check_worker(void* argument);
+#else
+DWORD WINAPI crazy_check_worker(LPVOID argument);
+#endif
+unsigned int rotate_r(unsigned int d);
+int load_malbolge_program(struct Disassembler* disassembler, struct VMState* initial_state, const char* malbolge_file);
+int find_entrypoint(struct Disassembler* disassembler, struct VMState* entry_state, long long* steps_to_entrypoint, const struct VMState* initial_state, int use_jit,
+		struct EventTrace* pre_entry_events);
+int interactive_access_analysis(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, struct CoverageLimits limits);
+void save_interactive_transcript(struct Disassembler* disassembler, const struct UserInput* input, const struct OutputSink* output, int run);
+int transcript_access_analysis(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, char** user_input_files,
+		struct CoverageLimits limits, struct Checkpoint* checkpoint);
+struct TranscriptBranch* create_root_run(const struct VMState* entry_state);
+int replay_single_transcript(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, char* filename,
+		struct CoverageLimits limits, int* interrupted);
+int minimize_transcripts(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, char** user_input_files,
+		struct CoverageLimits limits, char*** selected_files, struct CoverageFeatures* features);
+void set_coverage_limits(struct AccessAnalysis* accesses, struct CoverageLimits limits);
+void print_coverage_truncation(struct Disassembler* disassembler, int truncated, struct CoverageLimits limits);
+int replay_transcript_trie(struct TranscriptTrie* trie, struct TranscriptBranch* runs, int number_of_runs, struct AccessAnalysis* accesses,
+		struct Checkpoint* checkpoint);
+void account_transcript_lane(struct TranscriptLane* lane, struct AccessAnalysis* accesses);
+int save_transcript_checkpoint(struct Checkpoint* checkpoint, struct TranscriptTrie* trie, struct TranscriptLane* lanes,
+		const struct TranscriptBranch* branches, int number_of_branches, struct AccessAnalysis* accesses);
+int start_transcript_lane(struct TranscriptTrie* trie, struct TranscriptLane* lane, struct TranscriptBranch** branches,
+		int* number_of_branches, int* branches_capacity, struct AccessAnalysis* accesses);
+void feed_transcript_lane(struct TranscriptTrie* trie, struct TranscriptLane* lane, size_t fed, struct AccessAnalysis* accesses);
+void verify_transcript_output(struct TranscriptTrie* trie, struct TranscriptLane* lane);
+void report_transcript_output(struct Disassembler* disassembler, const struct VMState* entry_state, const struct TranscriptFile* file);
+int add_transcript_node(struct TranscriptTrie* trie, unsigned char* input, size_t length, int eof);
+int get_transcript_child(struct TranscriptTrie* trie, int node, unsigned char* input, size_t length, int eof);
+int add_transcript(struct TranscriptTrie* trie, const struct UserInput* transcript);
+int waits_for_input(const struct VMState* state);
+int has_halted(const struct VMState* state);
+int optimize_entrypoint(struct Disassembler* disassembler, struct VMState* entry_state, long long* steps_to_entrypoint, struct AccessAnalysis* accesses,
+		const struct VMState* initial_state, int use_jit, struct EventTrace* pre_entry_events);
+long long find_optimized_entrypoint_in_trace(struct EventTraceReader* reader, long long steps_to_entrypoint, const struct AccessAnalysis* accesses);
+int extract_codeblocks(struct Disassembler* disassembler, struct ConnectedMemoryCells** creg_components, struct ConnectedMemoryCells** dreg_components,
+		struct AccessAnalysis* accesses, const struct FlowGraph* graph, const struct VMState* entry_state, int use_jit);
+int set_circular_cell_order(struct ConnectedMemoryCells* block, struct avl_table* cells);
+int freeze_flow_graph(struct FlowGraph* graph, struct AccessAnalysis* accesses);
+struct avl_table* flow_graph_set(const struct AccessAnalysis* accesses, int cell, int kind);
+void free_flow_graph(struct FlowGraph* graph);
+int export_flow_graph(const struct FlowGraph* graph, const char* filename);
+const struct MemoryCellInfo* find_cell_edge_sets(const struct AccessAnalysis* accesses, int cell);
+struct MemoryCellInfo* cell_edge_sets(struct AccessAnalysis* accesses, int cell);
+void* copy_integer(void* avl_item, void* avl_param);
+void free_integer(void* avl_item, void* avl_param);
+struct avl_table** edge_set_of_kind(struct MemoryCellInfo* cell, int kind);
+struct EdgeSetPage* copy_edge_set_page(const struct EdgeSetPage* page);
+void release_edge_set_page(struct EdgeSetPage* page);
+void add_dreg_normal_successor(struct AccessAnalysis* accesses, int cell, int successor);
+void add_dreg_normal_predecessors(struct AccessAnalysis* accesses, int cell, int successor);
+void add_jmp_destination(struct AccessAnalysis* accesses, int cell, int destination);
+void add_movd_destination(struct AccessAnalysis* accesses, int cell, int destination);
+int init_edge_log(struct EdgeLog* edges);
+void apply_edge(struct AccessAnalysis* accesses, unsigned long long edge);
+void log_edge(struct AccessAnalysis* accesses, int kind, int cell, int target);
+int encrypt_command(int value);
+void clear_trace_cache(struct TraceCache* cache);
+struct Trace* find_trace(struct TraceCache* cache, const struct VMState* state);
+struct Trace* record_trace(struct TraceCache* cache, const struct VMState* state);
+int compile_trace(struct TraceCache* cache, struct Trace* trace);
+long long execute_commands(struct VMState* state, int interactive, struct UserInput* input, struct BreakCondition break_on, long long* last_jmp, int* interrupted, struct AccessAnalysis* accesses, int access_analysis_ro, struct EventTrace* events,
+		struct ExecutionContinuation* continuation);
+void record_event(struct EventTrace* events, int kind, long long step, int value);
+void init_execution_context(struct ExecutionContext* context, struct VMState* state, int interactive, struct UserInput* input, struct BreakCondition break_on,
+		long long* last_jmp, int* interrupted, struct AccessAnalysis* accesses, int access_analysis_ro, struct EventTrace* events,
+		struct ExecutionContinuation* continuation);
+int execute_step(struct ExecutionContext* context);
+int reaches_breakpoint(const struct BreakCondition* break_on, const struct VMState* state, int instruction);
+void set_dreg_rw_access(struct AccessAnalysis* accesses, int cell);
+void add_access_flag(struct AccessAnalysis* accesses, int cell, int flag);
+int coverage_limit_reached(struct ExecutionContext* context);
+void decide_a_register(struct AccessAnalysis* accesses, int matters);
+#ifndef WINDOWS
+void sigint_handler(int s);
+#else
+BOOL WINAPI sigint_handler(DWORD signal);
+#endif
+void print_instruction(struct TextBuffer* out, int value, int position);
+void print_xlat_cycle(struct TextBuffer* out, int value, int position);
+void emit_code_block(struct TextBuffer* out, const struct ConnectedMemoryCells* block, const struct AccessAnalysis* accesses,
+		const struct VMState* entry_state, struct DebugRecords* debug);
+void emit_data_block(struct TextBuffer* out, const struct ConnectedMemoryCells* block, const struct AccessAnalysis* accesses,
+		const struct VMState* entry_state, struct DebugRecords* debug);
+void record_debug_line(struct DebugRecords* debug, const struct TextBuffer* out, int kind, int address, const struct AccessAnalysis* accesses,
+		const struct VMState* entry_state);
+long long number_text_lines(const struct TextBuffer* text, struct DebugRecords* debug, long long lines_before);
+#ifndef WINDOWS
+void* emitter_worker(void* argument);
+#else
+DWORD WINAPI emitter_worker(LPVOID argument);
+#endif
+int emit_blocks(FILE* output_file, long long lines_before, const struct ConnectedMemoryCells* creg_components,
+		const struct ConnectedMemoryCells* dreg_components, const struct AccessAnalysis* accesses, const struct VMState* entry_state,
+		struct DebugRecords* debug);
+int is_nop(int instruction);
+
+int compare_integer (const void* avl_a, const void* avl_b, void* avl_param) {
+	if (*((int*)avl_a) > *((int*)avl_b))
+		return 1;
+	else if (*((int*)avl_a) < *((int*)avl_b))
+		return -1;
+	else
+		return 0;
+}
+
+void init_disassembler(struct Disassembler* disassembler) {
+	memset(disassembler, 0, sizeof(struct Disassembler));
+}
+
+void init_tables() {
+	init_instruction_tables();
+	init_trit_tables();
+}
+
+#ifdef WINDOWS
+BOOL CALLBACK init_tables_once(PINIT_ONCE once, PVOID parameter, PVOID* context) {
+	init_tables();
+	return TRUE;
+}
+#endif
+
+int disassemble(struct Disassembler* disassembler, const char* malbolge_file, const char* output_filename) {
+	struct Disassembler* outer_disassembler = current_disassembler;
+	struct DisassemblerBuffers* buffers = 0;
+	struct FlowGraph graph;
+	struct ConnectedMemoryCells* creg_components = 0;
+	struct ConnectedMemoryCells* dreg_components = 0;
+	FILE* pre_entry_file = 0;
+	struct EventTrace pre_entry_events; // run from initial state; may become large, so it is streamed into a temporary file
+	struct OutputSink terminal_output;
+	long long* first_executed = 0;
+	int result;
+
+	disassembler->error = MD_OK;
+	disassembler->error_message[0] = 0;
+	disassembler->interrupt = 0;
+	disassembler->budget_exhausted = 0;
+	disassembler->steps = 0;
+	disassembler->budget_deadline = 0;
+	if (disassembler->budget.deadline_seconds > 0) {
+		disassembler->budget_deadline = time(0) + disassembler->budget.deadline_seconds;
+	}
+	disassembler->budget_countdown = BUDGET_POLL_STEPS;
+	disassembler->budget_enforced = 1;
+	if (!malbolge_file || !output_filename) {
+		return report_error(disassembler, MD_ERROR_ARGUMENTS, "Missing file name.");
+	}
+#ifndef WINDOWS
+	pthread_once(&tables_initialized, init_tables);
+#else
+	InitOnceExecuteOnce(&tables_initialized, init_tables_once, 0, 0);
+#endif
+
+	if (!disassembler->buffers) {
+		// kept for the next calls
+		buffers = (DisassemblerBuffers*)malloc(sizeof(DisassemblerBuffers));
+		if (!buffers) {
+			return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+		}
+		buffers->initial_state = (VMState*)malloc(sizeof(VMState));
+		buffers->entry_state = (VMState*)malloc(sizeof(VMState));
+		buffers->accesses = (AccessAnalysis*)malloc(sizeof(AccessAnalysis));
+		disassembler->buffers = buffers;
+		if (!buffers->initial_state || !buffers->entry_state || !buffers->accesses) {
+			free_disassembler(disassembler);
+			return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+		}
+		memset(buffers->accesses, 0, sizeof(struct AccessAnalysis));
+	}
+	buffers = disassembler->buffers;
+	if (disassembler->debug_filename) {
+		int i;
+		first_executed = (long long*)malloc(sizeof(long long)*59049);
+		if (!first_executed) {
+			return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+		}
+		for (i=0;i<59049;i++) {
+			first_executed[i] = -1;
+		}
+	}
+	buffers->accesses->first_executed = first_executed;
+	memset(&graph, 0, sizeof(struct FlowGraph));
+	pre_entry_file = tmpfile();
+	init_event_trace(&pre_entry_events, pre_entry_file);
+
+	// a disassemble call may be nested in the progress callback of another one
+	current_disassembler = disassembler;
+	init_output_sink(&terminal_output, OUTPUT_STDOUT | OUTPUT_HASH);
+	disassembler->terminal_output = &terminal_output;
+	result = run_disassembler(disassembler, malbolge_file, output_filename, buffers->initial_state, buffers->entry_state, buffers->accesses, &graph,
+			&creg_components, &dreg_components, pre_entry_file?&pre_entry_events:0);
+	flush_output(&terminal_output);
+	free_output_sink(&terminal_output);
+	disassembler->terminal_output = 0;
+	current_disassembler = outer_disassembler;
+	if (result != 0 && disassembler->error == MD_OK) {
+		report_error(disassembler, MD_ERROR_INTERNAL, "Internal error.");
+	}
+
+	if (pre_entry_file) {
+		fclose(pre_entry_file);
+	}
+	free_flow_graph(&graph);
+	free_codeblocks(creg_components);
+	free_codeblocks(dreg_components);
+	buffers->accesses->first_executed = 0;
+	if (first_executed) {
+		free(first_executed);
+	}
+	reset_access_analysis(buffers->accesses);
+	return disassembler->error;
+}
+
+void free_disassembler(struct Disassembler* disassembler) {
+	struct DisassemblerBuffers* buffers = disassembler->buffers;
+	if (!buffers) {
+		return;
+	}
+	if (buffers->accesses) {
+		free_access_analysis(buffers->accesses);
+		free(buffers->accesses);
+	}
+	if (buffers->entry_state) {
+		free(buffers->entry_state);
+	}
+	if (buffers->initial_state) {
+		free(buffers->initial_state);
+	}
+	free(buffers);
+	disassembler->buffers = 0;
+}
+
+int check_engines(struct Disassembler* disassembler, const char* malbolge_file, long long interval) {
+	struct Disassembler* outer_disassembler = current_disassembler;
+	struct LockstepEngine engines[3];
+	struct VMState* states = 0; // initial state, last state all engines have agreed on, one for each engine
+	struct SigintHandler handler;
+	int number_of_engines = 0;
+	int result;
+	int i;
+
+	disassembler->error = MD_OK;
+	disassembler->error_message[0] = 0;
+	disassembler->interrupt = 0;
+	disassembler->budget_exhausted = 0;
+	disassembler->steps = 0;
+	disassembler->budget_deadline = 0;
+	disassembler->budget_enforced = 0; // every engine would be charged; the steps of a run are counted by the check
+	if (!malbolge_file || interval <= 0) {
+		return report_error(disassembler, MD_ERROR_ARGUMENTS, "Missing file name or interval.");
+	}
+#ifndef WINDOWS
+	pthread_once(&tables_initialized, init_tables);
+#else
+	InitOnceExecuteOnce(&tables_initialized, init_tables_once, 0, 0);
+#endif
+
+	memset(engines, 0, sizeof(engines));
+	engines[number_of_engines++].name = "reference implementation";
+	engines[number_of_engines].name = "trace cache";
+	engines[number_of_engines++].cache = create_trace_cache(0);
+	if (disassembler->use_jit) {
+		engines[number_of_engines].name = "JIT";
+		engines[number_of_engines++].cache = create_trace_cache(1);
+	}
+	states = (struct VMState*)malloc(sizeof(struct VMState)*(2+number_of_engines));
+	for (i=1;i<number_of_engines;i++) {
+		if (!engines[i].cache && states) {
+			free(states);
+			states = 0;
+		}
+	}
+	if (!states) {
+		report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}else{
+		for (i=0;i<number_of_engines;i++) {
+			engines[i].state = &states[2+i];
+		}
+		current_disassembler = disassembler;
+		if (install_sigint_handler(disassembler, &handler)) {
+			report_error(disassembler, MD_ERROR_SYSTEM, "Cannot install the handler of CTRL+C.");
+		}else{
+			result = run_engine_check(disassembler, malbolge_file, interval, &states[0], &states[1], engines, number_of_engines);
+			restore_sigint_handler(&handler);
+			if (result != 0 && disassembler->error == MD_OK) {
+				report_error(disassembler, MD_ERROR_INTERNAL, "Internal error.");
+			}
+		}
+		current_disassembler = outer_disassembler;
+	}
+
+	for (i=1;i<number_of_engines;i++) {
+		free_trace_cache(engines[i].cache);
+	}
+	if (states) {
+		free(states);
+	}
+	return disassembler->error;
+}
+
+// the runs of check_engines, one for each input file. engines[0] is the reference implementation.
+int run_engine_check(struct Disassembler* disassembler, const char* malbolge_file, long long interval, struct VMState* initial_state,
+		struct VMState* agreed_state, struct LockstepEngine* engines, int number_of_engines) {
+	char** files = disassembler->user_input_files;
+	long long maximal_steps = disassembler->budget.maximal_steps;
+	struct LockstepEngine* reference = &engines[0];
+	int run, i;
+
+	if (load_malbolge_program(disassembler, initial_state, malbolge_file)) {
+		return 1;
+	}
+	report_progress(disassembler, "The disassembler compares the %s%s with the reference implementation every %lld steps.\n",
+			engines[1].name, number_of_engines > 2 ? " and the JIT" : "", interval);
+	for (run=0;run==0 || (files && files[run]);run++) {
+		struct TranscriptFile transcript;
+		const struct UserInput* input = 0;
+		const char* end = "has halted";
+		long long steps = 0;
+
+		memset(&transcript, 0, sizeof(struct TranscriptFile));
+		if (files) {
+			int result = open_transcript_file(&transcript, files[run]);
+			if (result) {
+				return report_error(disassembler, MD_ERROR_FILE, result == 1 ? "Cannot open input file %s." :
+						"Input file %s has been saved by another version of the disassembler.", files[run]);
+			}
+			input = &transcript.input;
+		}
+		for (i=0;i<number_of_engines;i++) {
+			copy_state(engines[i].state, initial_state);
+			engines[i].input_pos = 0;
+			if (engines[i].cache) {
+				clear_trace_cache(engines[i].cache);
+			}
+		}
+		while (1) {
+			long long chunk = interval;
+			size_t agreed_input_pos = reference->input_pos;
+			int interrupted = 0;
+			if (maximal_steps > 0 && maximal_steps - steps < chunk) {
+				chunk = maximal_steps - steps;
+			}
+			if (chunk <= 0) {
+				end = "has reached the step limit";
+				break;
+			}
+			copy_state(agreed_state, reference->state);
+			for (i=0;i<number_of_engines;i++) {
+				int engine_interrupted = 0;
+				run_lockstep_engine(&engines[i], input, chunk, &engine_interrupted);
+				interrupted |= engine_interrupted;
+			}
+			if (interrupted) {
+				close_transcript_file(&transcript);
+				return report_error(disassembler, MD_ERROR_CANCELED, "The check has been interrupted after %lld steps.", steps);
+			}
+			for (i=1;i<number_of_engines;i++) {
+				if (lockstep_diverged(reference, &engines[i])) {
+					locate_divergence(disassembler, reference, &engines[i], agreed_state, agreed_input_pos, input, steps, chunk);
+					close_transcript_file(&transcript);
+					return disassembler->error;
+				}
+			}
+			steps += reference->steps;
+			if (reference->steps < chunk) {
+				if (waits_for_input(reference->state)) {
+					end = "waits for more input";
+				}else if (!has_halted(reference->state)) {
+					end = "has reached an invalid command";
+				}
+				break;
+			}
+		}
+		close_transcript_file(&transcript);
+		if (files) {
+			report_progress(disassembler, "The run with input file %s %s after %lld steps; all engines agree.\n", files[run], end, steps);
+		}else{
+			report_progress(disassembler, "The run without input %s after %lld steps; all engines agree.\n", end, steps);
+		}
+	}
+	return 0;
+}
+
+int run_to_breakpoint(struct Disassembler* disassembler, const char* malbolge_file, const struct Breakpoints* breakpoints) {
+	struct Disassembler* outer_disassembler = current_disassembler;
+	struct BreakCondition break_on = {0, 0, 0};
+	struct TranscriptFile transcript;
+	struct UserInput terminal_input;
+	struct OutputSink terminal_output;
+	struct SigintHandler handler;
+	struct VMState* state = 0;
+	int interactive = !disassembler->user_input_files;
+	int interrupted = 0;
+	long long steps;
+
+	disassembler->error = MD_OK;
+	disassembler->error_message[0] = 0;
+	disassembler->interrupt = 0;
+	disassembler->budget_exhausted = 0;
+	disassembler->steps = 0;
+	disassembler->budget_deadline = 0;
+	disassembler->budget_enforced = 0; // the steps are limited by the BreakCondition
+	if (!malbolge_file || !breakpoints) {
+		return report_error(disassembler, MD_ERROR_ARGUMENTS, "Missing file name or breakpoints.");
+	}
+#ifndef WINDOWS
+	pthread_once(&tables_initialized, init_tables);
+#else
+	InitOnceExecuteOnce(&tables_initialized, init_tables_once, 0, 0);
+#endif
+
+	break_on.maximal_steps = disassembler->budget.maximal_steps;
+	break_on.on_c = breakpoints->has_code ? breakpoints->code : 0;
+	break_on.on_read = breakpoints->has_reads ? breakpoints->reads : 0;
+	break_on.on_write = breakpoints->has_writes ? breakpoints->writes : 0;
+	break_on.on_register = breakpoints->on_register;
+	break_on.register_value = breakpoints->register_value;
+
+	memset(&transcript, 0, sizeof(struct TranscriptFile));
+	memset(&terminal_input, 0, sizeof(struct UserInput));
+	if (!interactive) {
+		int result = open_transcript_file(&transcript, disassembler->user_input_files[0]);
+		if (result) {
+			return report_error(disassembler, MD_ERROR_FILE, result == 1 ? "Cannot open input file %s." :
+					"Input file %s has been saved by another version of the disassembler.", disassembler->user_input_files[0]);
+		}
+	}
+	state = (struct VMState*)malloc(sizeof(struct VMState));
+	if (!state) {
+		close_transcript_file(&transcript);
+		return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+
+	current_disassembler = disassembler;
+	init_output_sink(&terminal_output, OUTPUT_STDOUT);
+	disassembler->terminal_output = &terminal_output;
+	if (!load_malbolge_program(disassembler, state, malbolge_file)) {
+		if (install_sigint_handler(disassembler, &handler)) {
+			report_error(disassembler, MD_ERROR_SYSTEM, "Cannot install the handler of CTRL+C.");
+		}else{
+			report_progress(disassembler, "Running Malbolge program...\n");
+			steps = execute(state, interactive, interactive ? &terminal_input : &transcript.input, break_on, 0, &interrupted, 0, 0, 0);
+			restore_sigint_handler(&handler);
+			if (terminal_output.length > 0) {
+				// the output may end without a line break
+				report_progress(disassembler, "\n");
+			}
+			report_break(disassembler, state, &break_on, steps, interrupted);
+		}
+	}
+	flush_output(&terminal_output);
+	free_output_sink(&terminal_output);
+	disassembler->terminal_output = 0;
+	current_disassembler = outer_disassembler;
+
+	free_user_input(&terminal_input);
+	close_transcript_file(&transcript);
+	free(state);
+	return disassembler->error;
+}
+
+// describes why execute has stopped the run of run_to_breakpoint and the state of the program
+void report_break(struct Disassembler* disassembler, const struct VMState* state, const struct BreakCondition* break_on, long long steps,
+		int interrupted) {
+	int instruction = state->memory[state->c];
+	const char* command = "(invalid)";
+	const char* reason;
+
+	if (instruction >= 33 && instruction <= 126) {
+		instruction = instruction_table[instruction-33][state->c%94];
+		command = instruction_names[instruction];
+	}else{
+		instruction = -1;
+	}
+	if (interrupted) {
+		reason = "has been interrupted";
+	}else if (break_on->maximal_steps > 0 && steps >= break_on->maximal_steps) {
+		reason = "has reached the step limit";
+	}else if (instruction != -1 && reaches_breakpoint(break_on, state, instruction)) {
+		if (break_on->on_c && BREAKPOINT_SET(break_on->on_c, state->c)) {
+			reason = "has reached a breakpoint";
+		}else if (break_on->on_write && (instruction == 39 || instruction == 62) && BREAKPOINT_SET(break_on->on_write, state->d)) {
+			reason = "writes a watched memory cell";
+		}else if (break_on->on_read && BREAKPOINT_SET(break_on->on_read, state->d)) {
+			reason = "reads a watched memory cell";
+		}else{
+			reason = "meets the register condition";
+		}
+	}else if (instruction == 81) {
+		reason = "has halted";
+	}else if (instruction == 23) {
+		reason = "waits for more input";
+	}else{
+		reason = "has reached an invalid command";
+	}
+	report_progress(disassembler, "The Malbolge program %s after %lld steps.\n", reason, steps);
+	report_progress(disassembler, "  c = 0x%05x: %s\n  d = 0x%05x: memory[d] = 0x%05x\n  a = 0x%05x\n", state->c, command, state->d,
+			state->memory[state->d], state->a);
+}
+
+// the steps of disassemble; the caller frees everything allocated here.
+int run_disassembler(struct Disassembler* disassembler, const char* malbolge_file, const char* output_filename, struct VMState* initial_state,
+		struct VMState* entry_state, struct AccessAnalysis* accesses, struct FlowGraph* graph, struct ConnectedMemoryCells** creg_components,
+		struct ConnectedMemoryCells** dreg_components, struct EventTrace* pre_entry_events) {
+	long long steps_to_entrypoint = 0;
+	FILE* output_file = 0;
+	struct TextBuffer header;
+	long long header_lines = 0;
+	struct DebugRecords debug;
+	struct CoverageLimits limits = disassembler->limits;
+	struct Checkpoint checkpoint;
+	int resumed = 0;
+	int result;
+
+	memset(&checkpoint, 0, sizeof(struct Checkpoint));
+	if (disassembler->checkpoint_filename && !disassembler->user_input_files) {
+		return report_error(disassembler, MD_ERROR_ARGUMENTS, "Checkpoints are only available for the analysis with input files.");
+	}
+	if (disassembler->minimize_filename && (!disassembler->user_input_files || disassembler->checkpoint_filename)) {
+		return report_error(disassembler, MD_ERROR_ARGUMENTS, "The minimization needs input files and cannot be combined with checkpoints.");
+	}
+	result = load_malbolge_program(disassembler, initial_state, malbolge_file);
+	if (result != 0) {
+		return result;
+	}
+	if (disassembler->checkpoint_filename) {
+		checkpoint.filename = disassembler->checkpoint_filename;
+		checkpoint.interval = (disassembler->checkpoint_seconds > 0 ? disassembler->checkpoint_seconds : CHECKPOINT_SECONDS);
+		checkpoint.entry_state = entry_state;
+		if (checkpoint_key(malbolge_file, disassembler->user_input_files, &checkpoint.key)) {
+			return report_error(disassembler, MD_ERROR_FILE, "Cannot read the input files.");
+		}
+		result = load_checkpoint(&checkpoint, entry_state, accesses);
+		if (accesses->error) {
+			return report_error(disassembler, accesses->error, "Not enough memory.");
+		}
+		if (result == 2) {
+			report_progress(disassembler, "\nThe checkpoint file %s does not belong to this Malbolge program and its input\nfiles. It will be replaced.\n",
+					checkpoint.filename);
+		}
+		resumed = (result == 0);
+	}
+	if (resumed) {
+		// the run to the entry point has not been recorded by this call
+		steps_to_entrypoint = checkpoint.steps_to_entrypoint;
+		pre_entry_events = 0;
+		report_progress(disassembler, "\nThe analysis is resumed from the checkpoint file %s.\nEntry point found at step %lld.\n",
+				checkpoint.filename, steps_to_entrypoint);
+	}else{
+		result = find_entrypoint(disassembler, entry_state, &steps_to_entrypoint, initial_state, disassembler->use_jit, pre_entry_events);
+		if (result != 0) {
+			return result;
+		}
+		checkpoint.steps_to_entrypoint = steps_to_entrypoint;
+	}
+	accesses->start_step = steps_to_entrypoint;
+	if (disassembler->user_input_files) {
+		char** selected_files = 0;
+		struct CoverageFeatures features;
+		memset(&features, 0, sizeof(struct CoverageFeatures));
+		if (disassembler->minimize_filename) {
+			result = minimize_transcripts(disassembler, accesses, entry_state, disassembler->user_input_files, limits, &selected_files, &features);
+		}
+		if (result == 0) {
+			result = transcript_access_analysis(disassembler, accesses, entry_state, selected_files ? selected_files : disassembler->user_input_files,
+					limits, &checkpoint);
+		}
+		if (result == 0 && selected_files) {
+			struct CoverageFeatures analyzed;
+			if (collect_coverage_features(accesses, &analyzed)) {
+				result = report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+			}else if (analyzed.length != features.length ||
+					memcmp(analyzed.features, features.features, sizeof(unsigned long long)*features.length) != 0) {
+				report_progress(disassembler, "Warning: the analysis of the selected input files differs from the analysis of\nthe input files on their own.\n");
+			}
+			free_coverage_features(&analyzed);
+		}
+		if (selected_files) {
+			free(selected_files);
+		}
+		free_coverage_features(&features);
+	}else{
+		result = interactive_access_analysis(disassembler, accesses, entry_state, limits);
+	}
+	if (result != 0) {
+		return result;
+	}
+	result = optimize_entrypoint(disassembler, entry_state, &steps_to_entrypoint, accesses, initial_state, disassembler->use_jit, pre_entry_events);
+	if (result != 0) {
+		return result;
+	}
+
+	if (freeze_flow_graph(graph, accesses) || accesses->error) {
+		return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+	if (disassembler->graph_filename && export_flow_graph(graph, disassembler->graph_filename)) {
+		return report_error(disassembler, MD_ERROR_FILE, "Cannot write to file: %s",disassembler->graph_filename);
+	}
+	result = extract_codeblocks(disassembler, creg_components, dreg_components, accesses, graph, entry_state, disassembler->use_jit);
+	free_flow_graph(graph);
+	if (result != 0) {
+		return result;
+	}
+	if (disassembler->budget_exhausted) {
+		char budgets[64];
+		describe_exhausted_budget(budgets, sizeof(budgets), disassembler->budget_exhausted);
+		report_progress(disassembler, "The %s budget has been exhausted. The HeLL file will be partial.\n", budgets);
+	}
+
+
+	// TODO: find label-positions and preceeding RNops... (maybe not so important)
+
+
+
+	report_progress(disassembler, "Malbolge disassembler has finished its analysis of the Malbolge program.\n");
+	report_progress(disassembler, "Malbolge disassembler will generate the HeLL file now. Please wait...");
+	// TODO: generate HeLL-code from creg_components, dreg_components, and initial A-value:
+	// TODO: output blocks; regard fixed offsets, entry state: ENTRY as well as initial A register value
+	
+	output_file = fopen(output_filename, "w");
+	if (!output_file) {
+		return report_error(disassembler, MD_ERROR_FILE, "Cannot write to file: %s",output_filename);
+	}
+	// the lines of the header are counted for the debug information
+	init_text_buffer(&header);
+	if (accesses->coverage_truncated) {
+		buffer_printf(&header,"// The flow analysis has been truncated:");
+		if (accesses->coverage_truncated & COVERAGE_SATURATED) {
+			buffer_printf(&header," no new memory access information has been found for");
+			if (limits.window_steps > 0) {
+				buffer_printf(&header," %d steps",limits.window_steps);
+			}
+			if (limits.window_steps > 0 && limits.window_seconds > 0) {
+				buffer_printf(&header," or");
+			}
+			if (limits.window_seconds > 0) {
+				buffer_printf(&header," %d second%s",limits.window_seconds,limits.window_seconds==1?"":"s");
+			}
+			buffer_printf(&header,"%s",(accesses->coverage_truncated & DEADLINE_REACHED)?";":".");
+		}
+		if (accesses->coverage_truncated & DEADLINE_REACHED) {
+			buffer_printf(&header," the deadline of %d second%s has been reached.",limits.deadline_seconds,limits.deadline_seconds==1?"":"s");
+		}
+		buffer_printf(&header,"\n");
+	}
+	if (disassembler->budget_exhausted) {
+		char budgets[64];
+		describe_exhausted_budget(budgets, sizeof(budgets), disassembler->budget_exhausted);
+		buffer_printf(&header,"// This is a partial result: the %s budget of the disassembler has been exhausted.\n", budgets);
+	}
+	if (accesses->coverage_truncated || disassembler->budget_exhausted) {
+		buffer_printf(&header,"// Code or data used by later parts of the Malbolge program may be missing.\n\n");
+	}
+	header_lines = number_text_lines(&header, 0, 0);
+	memset(&debug, 0, sizeof(struct DebugRecords));
+	if (write_text_buffer(output_file, &header) ||
+			emit_blocks(output_file, header_lines, *creg_components, *dreg_components, accesses, entry_state, disassembler->debug_filename ? &debug : 0)) {
+		fclose(output_file);
+		free_debug_records(&debug);
+		return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+	
+	// TODO: initial A value
+	
+	if (fclose(output_file) != 0) {
+		free_debug_records(&debug);
+		return report_error(disassembler, MD_ERROR_FILE, "Cannot write to file: %s",output_filename);
+	}
+	if (disassembler->debug_filename) {
+		int failed = write_debug_info(disassembler->debug_filename, &debug);
+		free_debug_records(&debug);
+		if (failed) {
+			return report_error(disassembler, MD_ERROR_FILE, "Cannot write to file: %s",disassembler->debug_filename);
+		}
+	}
+
+	report_progress(disassembler, " done.\n");
+	return 0;
+}
+
+// names the budgets of exhausted, e.g. "time and memory"
+void describe_exhausted_budget(char* text, size_t size, int exhausted) {
+	const char* names[3] = {"time", "step", "memory"};
+	int flags[3] = {MD_BUDGET_TIME, MD_BUDGET_STEPS, MD_BUDGET_MEMORY};
+	int count = 0;
+	int i;
+	text[0] = 0;
+	for (i=0;i<3;i++) {
+		if (exhausted & flags[i]) {
+			count++;
+		}
+	}
+	for (i=0;i<3;i++) {
+		if (exhausted & flags[i]) {
+			count--;
+			strncat(text, names[i], size - strlen(text) - 1);
+			if (count > 0) {
+				strncat(text, count == 1 ? " and " : ", ", size - strlen(text) - 1);
+			}
+		}
+	}
+}
+
+// passes a progress message to the callback of disassembler
+void report_progress(struct Disassembler* disassembler, const char* format, ...) {
+	char message[1024];
+	va_list args;
+	if (!disassembler->progress) {
+		return;
+	}
+	if (disassembler->terminal_output) {
+		// keep the order of the Malbolge program's output and the messages
+		drain_output(disassembler->terminal_output);
+	}
+	va_start(args, format);
+	vsnprintf(message, sizeof(message), format, args);
+	va_end(args);
+	disassembler->progress(disassembler->user_data, message);
+}
+
+// stores the result of the disassemble call; returns error
+int report_error(struct Disassembler* disassembler, int error, const char* format, ...) {
+	va_list args;
+	disassembler->error = error;
+	va_start(args, format);
+	vsnprintf(disassembler->error_message, sizeof(disassembler->error_message), format, args);
+	va_end(args);
+	return error;
+}
+
+
+
+void init_instruction_tables() {
+	int value, position;
+	for (value=0;value<94;value++) {
+		instruction_names[value] = "Nop";
+	}
+	instruction_names[4] = "Jmp";
+	instruction_names[5] = "Out";
+	instruction_names[23] = "In";
+	instruction_names[39] = "Rot";
+	instruction_names[40] = "MovD";
+	instruction_names[62] = "Opr";
+	instruction_names[81] = "Hlt";
+
+	for (value=0;value<94;value++) {
+		for (position=0;position<94;position++) {
+			instruction_table[value][position] = (value+33+position)%94;
+		}
+	}
+	for (value=0;value<94;value++) {
+		for (position=0;position<94;position++) {
+			struct XlatCycleInfo* info = &xlat_cycle_table[value][position];
+			int instruction = instruction_table[value][position];
+			int tmp = value;
+			int cycle_len = 0;
+			int pure_nop_cycle = 1;
+			info->valid = !is_nop(instruction) || instruction == 68;
+			do {
+				if (!is_nop(instruction_table[tmp][position])) {
+					pure_nop_cycle = 0;
+				}
+				tmp = translation[tmp] - 33;
+				cycle_len++;
+			}while(tmp != value);
+			info->cycle_length = cycle_len;
+			info->pure_nop_cycle = pure_nop_cycle;
+			if (pure_nop_cycle) {
+				strcpy(info->text, "RNop");
+			}else if (cycle_len > 9) {
+				// probabliy use-once-code
+				strcpy(info->text, instruction_names[instruction]);
+			}else{
+				// print complete cycle: at most 9 commands with at most 4 characters each
+				info->text[0] = 0;
+				do {
+					if (info->text[0]) {
+						strcat(info->text, "/");
+					}
+					strcat(info->text, instruction_names[instruction_table[tmp][position]]);
+					tmp = translation[tmp] - 33;
+				}while(tmp != value);
+			}
+			info->text_length = strlen(info->text);
+		}
+	}
+}
+
+void print_instruction(struct TextBuffer* out, int value, int position) {
+	if (value >= 33 && value <= 126) {
+		buffer_puts(out, instruction_names[instruction_table[value-33][position%94]]);
+	}else{
+		buffer_puts(out, instruction_names[(value+position)%94]);
+	}
+}
+
+int is_nop(int instruction) {
+	switch (instruction){
+		case 4:
+		case 5:
+		case 23:
+		case 39:
+		case 40:
+		case 62:
+		case 81:
+			return 0;
+		case 68:
+		default:
+			return 1;
+	}
+}
+
+void print_xlat_cycle(struct TextBuffer* out, int value, int position) {
+	const struct XlatCycleInfo* info = 0;
+	if (value < 33 || value > 126) {
+		buffer_puts(out,"Invalid");
+		return;
+	}
+	info = &xlat_cycle_table[value-33][position%94];
+	buffer_write(out, info->text, info->text_length);
+}
+
+
+void init_text_buffer(struct TextBuffer* text) {
+	memset(text, 0, sizeof(struct TextBuffer));
+}
+
+void free_text_buffer(struct TextBuffer* text) {
+	if (text->data) {
+		free(text->data);
+	}
+	memset(text, 0, sizeof(struct TextBuffer));
+}
+
+int reserve_text_buffer(struct TextBuffer* text, size_t length) {
+	if (text->failed) {
+		return 1;
+	}
+	if (text->length + length + 1 > text->capacity) {
+		size_t capacity = text->capacity ? text->capacity : 4096;
+		char* tmp;
+		while (text->length + length + 1 > capacity) {
+			capacity *= 2;
+		}
+		tmp = (char*)realloc(text->data, capacity);
+		if (!tmp) {
+			text->failed = 1;
+			return 1;
+		}
+		text->data = tmp;
+		text->capacity = capacity;
+	}
+	return 0;
+}
+
+void buffer_write(struct TextBuffer* text, const char* data, size_t length) {
+	if (reserve_text_buffer(text, length)) {
+		return;
+	}
+	memcpy(text->data + text->length, data, length);
+	text->length += length;
+}
+
+void buffer_puts(struct TextBuffer* text, const char* data) {
+	buffer_write(text, data, strlen(data));
+}
+
+void buffer_printf(struct TextBuffer* text, const char* format, ...) {
+	va_list args;
+	int length;
+	// labels and numbers are short: try the space left first
+	if (reserve_text_buffer(text, 64)) {
+		return;
+	}
+	va_start(args, format);
+	length = vsnprintf(text->data + text->length, text->capacity - text->length, format, args);
+	va_end(args);
+	if (length < 0) {
+		text->failed = 1;
+		return;
+	}
+	if ((size_t)length >= text->capacity - text->length) {
+		if (reserve_text_buffer(text, length)) {
+			return;
+		}
+		va_start(args, format);
+		vsnprintf(text->data + text->length, text->capacity - text->length, format, args);
+		va_end(args);
+	}
+	text->length += length;
+}
+
+// writes the buffer in one piece and frees it. returns 1 if the buffer is incomplete.
+int write_text_buffer(FILE* file, struct TextBuffer* text) {
+	int failed = text->failed;
+	if (!failed && text->length) {
+		fwrite(text->data, 1, text->length, file);
+	}
+	free_text_buffer(text);
+	return failed;
+}
+
+// counts the lines of text and turns the offsets of the debug records into line numbers behind lines_before lines.
+// returns the number of lines.
+long long number_text_lines(const struct TextBuffer* text, struct DebugRecords* debug, long long lines_before) {
+	long long lines = 0;
+	size_t next = 0;
+	size_t i;
+	for (i=0;i<text->length;i++) {
+		// the records are in the order of their offsets
+		while (debug && next < debug->length && debug->records[next].line == (long long)i) {
+			debug->records[next++].line = lines_before + lines + 1;
+		}
+		if (text->data[i] == '\n') {
+			lines++;
+		}
+	}
+	return lines;
+}
+
+// records that the line about to be written to out belongs to address
+void record_debug_line(struct DebugRecords* debug, const struct TextBuffer* out, int kind, int address, const struct AccessAnalysis* accesses,
+		const struct VMState* entry_state) {
+	int value = entry_state->memory[address];
+	int xlat_cycle = 0;
+	if (value >= 33 && value <= 126) {
+		xlat_cycle = xlat_cycle_table[value-33][address%94].cycle_length;
+	}
+	add_debug_record(debug, (long long)out->length, kind, address, xlat_cycle, accesses->first_executed ? accesses->first_executed[address] : -1);
+}
+
+// writes the cells of a .CODE block
+void emit_code_block(struct TextBuffer* out, const struct ConnectedMemoryCells* block, const struct AccessAnalysis* accesses,
+		const struct VMState* entry_state, struct DebugRecords* debug) {
+	int last_executed_address = -2;
+	int i;
+	int ln_break_offset = 0;
+	// a block that wraps around from 59048 to 0 starts with its cells at the end of the memory
+	// (extract_codeblocks fixes its offset), so it is printed in one pass.
+	for (i=0;i<block->number_of_cells;i++) {
+		int set_label = 0;
+		int output_command = 0;
+		int c_pos = block->cells[i];
+		if (accesses->access[c_pos] & CREG_EXECUTED) {
+			output_command = 1;
+			if ((last_executed_address + 1)%59049 != c_pos) {
+				// set label, set offset if necessary
+				set_label = 1;
+				if (block->fixed_offset) {
+					// set offset
+					if (ln_break_offset) {
+						buffer_puts(out,"\n");
+					}
+					buffer_printf(out,".OFFSET %d\n", c_pos);
+				}
+			}
+			last_executed_address = c_pos;
+		}
+		if (accesses->access[c_pos] & CREG_REACHED_BY_JMP) {
+			// set label
+			set_label = 1;
+		}
+		if (set_label) {
+			if (debug) {
+				record_debug_line(debug, out, DEBUG_CODE_LABEL, c_pos, accesses, entry_state);
+			}
+			buffer_printf(out,"CODE_%d:\n", c_pos);
+		}
+		if (output_command) {
+			if (debug) {
+				record_debug_line(debug, out, DEBUG_COMMAND, c_pos, accesses, entry_state);
+			}
+			buffer_puts(out,"\t");
+			// command 2 cycle
+			if (accesses->access[c_pos] & CREG_TRANSLATED) {
+				print_xlat_cycle(out, entry_state->memory[c_pos], c_pos);
+			}else{
+				print_instruction(out, entry_state->memory[c_pos], c_pos);
+			}
+			buffer_puts(out,"\n");
+		}
+		ln_break_offset = 1;
+	}
+	buffer_puts(out, "\n");
+}
+
+// writes the cells of a .DATA block
+void emit_data_block(struct TextBuffer* out, const struct ConnectedMemoryCells* block, const struct AccessAnalysis* accesses,
+		const struct VMState* entry_state, struct DebugRecords* debug) {
+	int last_output_address = -1;
+	int j;
+	// a block that wraps around from 59048 to 0 continues at 0 behind 59048 (extract_codeblocks fixes its offset)
+	for (j=0;j<block->number_of_cells;j++) {
+		int set_label = 0;
+		int set_code_label = 0;
+		int print_offset = 0;
+		int d_pos = block->cells[j];
+		if (last_output_address < 0) {
+			set_label = 1;
+		}
+		if (block->fixed_offset && last_output_address < 0) {
+			print_offset = 1;
+		}
+		if (last_output_address >= 0 && (last_output_address + 1)%59049 != d_pos && !print_offset) {
+			// print out unused memory cells (to match offsets).
+			int i;
+			for (i=(last_output_address+1)%59049;i!=d_pos;i=(i+1)%59049) {
+				if (debug) {
+					record_debug_line(debug, out, DEBUG_DATA_WORD, i, accesses, entry_state);
+				}
+				buffer_write(out,"\t?-\n",4);
+			}
+		}
+		if (accesses->access[d_pos] & DREG_REACHED_BY_MOVD) {
+			set_label = 1;
+		}
+		if (accesses->access[d_pos] & CREG_REACHED_BY_JMP) {
+			set_code_label = 1;
+		}
+		
+		
+		if (print_offset) {
+			if (last_output_address >= 0){
+				buffer_puts(out,"\n");
+			}
+			buffer_printf(out,".OFFSET %d\n", d_pos);
+		}
+		// if at entry position:
+		if (d_pos == entry_state->d) {
+			if (accesses->a_register_matters) {
+				buffer_puts(out,"ORIGINAL_ENTRY:\n");
+			}else{
+				buffer_puts(out,"ENTRY:\n");
+			}
+		}
+		if (set_code_label) {
+			if (debug) {
+				record_debug_line(debug, out, DEBUG_CODE_LABEL, d_pos, accesses, entry_state);
+			}
+			buffer_printf(out,"CODE_%d:\n", d_pos);
+		}
+		if (set_label) {
+			if (debug) {
+				record_debug_line(debug, out, DEBUG_DATA_LABEL, d_pos, accesses, entry_state);
+			}
+			buffer_printf(out,"DATA_%d:\n", d_pos);
+		}
+
+		if (debug) {
+			record_debug_line(debug, out, DEBUG_DATA_WORD, d_pos, accesses, entry_state);
+		}
+		buffer_puts(out,"\t");
+		// print data word: LABEL or CONSTANT
+		if (accesses->access[d_pos] & DREG_ACCESS_RW) {
+			// CONSTANT
+			if (entry_state->memory[d_pos] == 0) {
+				buffer_puts(out,"C0");
+			}else if (entry_state->memory[d_pos] == 59048/2) {
+				buffer_puts(out,"C1");
+			}else if (entry_state->memory[d_pos] == 59048-2) {
+				buffer_puts(out,"C20");
+			}else if (entry_state->memory[d_pos] == 59048-1) {
+				buffer_puts(out,"C21");
+			}else if (entry_state->memory[d_pos] == 59048) {
+				buffer_puts(out,"C2");
+			}else if (entry_state->memory[d_pos] == '\n') {
+				buffer_puts(out,"'\\n'");
+			}else if (entry_state->memory[d_pos] >= 32 && entry_state->memory[d_pos] <= 126) {
+				buffer_printf(out,"'%c'",(char)entry_state->memory[d_pos]);
+			}else{
+				// TODO: as trinary number
+				buffer_printf(out,"%d",entry_state->memory[d_pos]);
+			}
+		}else if (accesses->access[d_pos] & DREG_ACCESS_JUMP) {
+			// CODE LABEL
+			buffer_printf(out,"CODE_%d",(entry_state->memory[d_pos]+1)%59049);
+		}else if (accesses->access[d_pos] & DREG_ACCESS_MOVD) {
+			// DATA LABEL
+			buffer_printf(out,"DATA_%d",(entry_state->memory[d_pos]+1)%59049);
+		}else if (accesses->access[d_pos] & DREG_REACHED_BY_MOVD){
+			// value does not matter, but cell must have a label, therefore must be "?" instead of "?-"
+			buffer_puts(out,"?");
+		}else{
+			// MUST NOT OCCUR
+			buffer_puts(out,"INVALID");
+		}
+		buffer_puts(out, "\n");
+		last_output_address = d_pos;
+		
+	}
+	buffer_puts(out, "\n");
+}
+
+// formats the blocks that have not been taken by another worker yet
+#ifndef WINDOWS
+void* emitter_worker(void* argument) {
+#else
+DWORD WINAPI emitter_worker(LPVOID argument) {
+#endif
+	struct BlockEmitter* emitter = (struct BlockEmitter*)argument;
+	while (1) {
+		struct EmitterJob* job;
+#ifndef WINDOWS
+		pthread_mutex_lock(&emitter->lock);
+#endif
+		if (emitter->next_job >= emitter->number_of_jobs) {
+#ifndef WINDOWS
+			pthread_mutex_unlock(&emitter->lock);
+#endif
+			break;
+		}
+		job = &emitter->jobs[emitter->next_job++];
+#ifndef WINDOWS
+		pthread_mutex_unlock(&emitter->lock);
+#endif
+		if (job->data) {
+			emit_data_block(&job->text, job->block, emitter->accesses, emitter->entry_state, emitter->debug ? &job->debug : 0);
+		}else{
+			emit_code_block(&job->text, job->block, emitter->accesses, emitter->entry_state, emitter->debug ? &job->debug : 0);
+		}
+	}
+	return 0;
+}
+
+// formats all blocks into separate buffers in parallel, then writes them in their order behind lines_before lines.
+// the lines that belong to memory cells are added to debug (optional).
+int emit_blocks(FILE* output_file, long long lines_before, const struct ConnectedMemoryCells* creg_components,
+		const struct ConnectedMemoryCells* dreg_components, const struct AccessAnalysis* accesses, const struct VMState* entry_state,
+		struct DebugRecords* debug) {
+	struct BlockEmitter emitter;
+	struct TextBuffer section;
+	long long lines = lines_before;
+	int number_of_creg_jobs = 0;
+	int number_of_threads = 1;
+	int failed = 0;
+	int i;
+	memset(&emitter, 0, sizeof(struct BlockEmitter));
+	while (creg_components[number_of_creg_jobs].cells) {
+		number_of_creg_jobs++;
+	}
+	while (dreg_components[emitter.number_of_jobs].cells) {
+		emitter.number_of_jobs++;
+	}
+	emitter.number_of_jobs += number_of_creg_jobs;
+	emitter.jobs = (struct EmitterJob*)malloc(sizeof(struct EmitterJob)*(emitter.number_of_jobs>0?emitter.number_of_jobs:1));
+	if (!emitter.jobs) {
+		return 1;
+	}
+	for (i=0;i<emitter.number_of_jobs;i++) {
+		emitter.jobs[i].data = (i >= number_of_creg_jobs);
+		emitter.jobs[i].block = emitter.jobs[i].data ? &dreg_components[i-number_of_creg_jobs] : &creg_components[i];
+		init_text_buffer(&emitter.jobs[i].text);
+		memset(&emitter.jobs[i].debug, 0, sizeof(struct DebugRecords));
+	}
+	emitter.accesses = accesses;
+	emitter.entry_state = entry_state;
+	emitter.debug = (debug != 0);
+
+#ifndef WINDOWS
+	{
+		pthread_t threads[MAX_EMITTER_THREADS];
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		if (processors > 1) {
+			number_of_threads = (processors > MAX_EMITTER_THREADS ? MAX_EMITTER_THREADS : (int)processors);
+		}
+		if (number_of_threads > emitter.number_of_jobs) {
+			number_of_threads = emitter.number_of_jobs;
+		}
+		pthread_mutex_init(&emitter.lock, 0);
+		// this thread is a worker as well
+		for (i=1;i<number_of_threads;i++) {
+			if (pthread_create(&threads[i], 0, emitter_worker, &emitter) != 0) {
+				break;
+			}
+		}
+		number_of_threads = i;
+		emitter_worker(&emitter);
+		for (i=1;i<number_of_threads;i++) {
+			pthread_join(threads[i], 0);
+		}
+		pthread_mutex_destroy(&emitter.lock);
+	}
+#else
+	emitter_worker(&emitter);
+#endif
+
+	for (i=0;i<=emitter.number_of_jobs;i++) {
+		init_text_buffer(&section);
+		if (i == 0) {
+			buffer_puts(&section,".CODE\n");
+			if (accesses->a_register_matters) {
+				buffer_puts(&section,"INIT_A:\n\tRot\n\tMovD\n\tJmp\n\n");
+			}
+		}
+		if (i == number_of_creg_jobs) {
+			buffer_puts(&section,".DATA\n");
+			if (accesses->a_register_matters) {
+				buffer_printf(&section,"ENTRY:\n\tINIT_A %d<<1\n\tORIGINAL_ENTRY\n\n", entry_state->a);
+			}
+		}
+		lines += number_text_lines(&section, 0, lines);
+		failed |= write_text_buffer(output_file, &section);
+		if (i == emitter.number_of_jobs) {
+			break;
+		}
+		if (debug) {
+			int data = emitter.jobs[i].data;
+			lines += number_text_lines(&emitter.jobs[i].text, &emitter.jobs[i].debug, lines);
+			failed |= append_debug_records(debug, &emitter.jobs[i].debug, data ? i-number_of_creg_jobs : i, data);
+			free_debug_records(&emitter.jobs[i].debug);
+		}
+		failed |= write_text_buffer(output_file, &emitter.jobs[i].text);
+	}
+	free(emitter.jobs);
+	if (failed) {
+		return 1;
+	}
+	return 0;
+}
+
+
+void init_trit_tables() {
+	int value, ones, twos;
+	for (value=0;value<243;value++) {
+		int tmp = value;
+		int k;
+		trit_planes_of_5[value] = 0;
+		for (k=0;k<5;k++) {
+			if (tmp%3 == 1) {
+				trit_planes_of_5[value] |= 1 << k;
+			}else if (tmp%3 == 2) {
+				trit_planes_of_5[value] |= 1 << (k+5);
+			}
+			tmp /= 3;
+		}
+	}
+	// planes with a trit that is 1 and 2 at the same time are invalid; they are never looked up
+	for (ones=0;ones<32;ones++) {
+		for (twos=0;twos<32;twos++) {
+			value_of_5_trits[ones][twos] = 0;
+		}
+	}
+	for (value=0;value<243;value++) {
+		value_of_5_trits[trit_planes_of_5[value] & 31][trit_planes_of_5[value] >> 5] = value;
+	}
+}
+
+// only the lower 10 trits are used, like crazy does
+struct TritWord to_trits(unsigned int value) {
+	struct TritWord word;
+	unsigned int low = trit_planes_of_5[value%243];
+	unsigned int high = trit_planes_of_5[(value/243)%243];
+	word.ones = (unsigned short)((low & 31) | ((high & 31) << 5));
+	word.twos = (unsigned short)((low >> 5) | ((high >> 5) << 5));
+	return word;
+}
+
+unsigned int from_trits(struct TritWord word) {
+	return value_of_5_trits[word.ones & 31][word.twos & 31] + 243*value_of_5_trits[word.ones >> 5][word.twos >> 5];
+}
+
+// crazy operation on all 10 trits at once. table (a: column, d: row):
+//      a=0 a=1 a=2
+// d=0   1   0   0
+// d=1   1   0   2
+// d=2   2   2   1
+struct TritWord crazy_trits(struct TritWord a, struct TritWord d) {
+	struct TritWord result;
+	unsigned int a_zeros = ~(a.ones | a.twos) & TRIT_WORD_MASK;
+	result.ones = (unsigned short)((a_zeros & ~d.twos) | (a.twos & d.twos));
+	result.twos = (unsigned short)((a.twos & d.ones) | (~a.twos & d.twos & TRIT_WORD_MASK));
+	return result;
+}
+
+unsigned int crazy(unsigned int a, unsigned int d){
+	return from_trits(crazy_trits(to_trits(a), to_trits(d)));
+}
+
+// reference of crazy: the original loop over the digits. it is only used by check_crazy.
+unsigned int crazy_digits(unsigned int a, unsigned int d){
+	unsigned int crz[] = {1,0,0,1,0,2,2,2,1};
+	int position = 0;
+	unsigned int output = 0;
+	while (position < 10){
+		unsigned int i = a%3;
+		unsigned int j = d%3;
+		unsigned int out = crz[i+3*j];
+		unsigned int multiple = 1;
+		int k;
+		for (k=0;k<position;k++)
+			multiple *= 3;
+		output += multiple*out;
+		a /= 3;
+		d /= 3;
+		position++;
+	}
+	return output;
+}
+
+// compares a row of operand pairs: a is the row for rows below 59049, d runs over all 10-trit values. the rows above
+// combine operands above 10 trits, of which only the lower 10 trits are used. returns 1 at the first pair that differs.
+int compare_crazy_row(struct CrazyCheck* check, int row) {
+	static const unsigned int high_operands[CRAZY_CHECK_HIGH_ROWS] = {59049, 2*59049, 177147, 14348907, 0x7FFFFFFFu - 59048, 0xFFFFFFFFu - 59048};
+	unsigned int operands[3][2];
+	unsigned int d;
+	int i;
+	if (row < 59049) {
+		for (d=0;d<59049;d++) {
+			if (crazy((unsigned int)row, d) != crazy_digits((unsigned int)row, d)) {
+				check->a = (unsigned int)row;
+				check->d = d;
+				return 1;
+			}
+		}
+		return 0;
+	}
+	for (d=0;d<59049;d++) {
+		unsigned int high = high_operands[row-59049];
+		unsigned int other = (d*7919)%59049;
+		operands[0][0] = high+d;
+		operands[0][1] = other;
+		operands[1][0] = other;
+		operands[1][1] = high+d;
+		operands[2][0] = high+d;
+		operands[2][1] = high+other;
+		for (i=0;i<3;i++) {
+			if (crazy(operands[i][0], operands[i][1]) != crazy_digits(operands[i][0], operands[i][1])) {
+				check->a = operands[i][0];
+				check->d = operands[i][1];
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+// compares the rows that have not been taken by another worker yet
+#ifndef WINDOWS
+void* crazy_check_worker(void* argument) {
+#else
+DWORD WINAPI crazy_check_worker(LPVOID argument) {
+#endif
+	struct CrazyCheck* check = (struct CrazyCheck*)argument;
+	struct CrazyCheck found;
+	while (1) {
+		int row;
+#ifndef WINDOWS
+		pthread_mutex_lock(&check->lock);
+#endif
+		if (check->failed || check->next_row >= 59049+CRAZY_CHECK_HIGH_ROWS) {
+#ifndef WINDOWS
+			pthread_mutex_unlock(&check->lock);
+#endif
+			break;
+		}
+		row = check->next_row++;
+#ifndef WINDOWS
+		pthread_mutex_unlock(&check->lock);
+#endif
+		if (compare_crazy_row(&found, row)) {
+#ifndef WINDOWS
+			pthread_mutex_lock(&check->lock);
+#endif
+			if (!check->failed) {
+				check->failed = 1;
+				check->a = found.a;
+				check->d = found.d;
+			}
+#ifndef WINDOWS
+			pthread_mutex_unlock(&check->lock);
+#endif
+			break;
+		}
+	}
+	return 0;
+}
+
+int check_crazy(struct Disassembler* disassembler) {
+	struct CrazyCheck check;
+	int number_of_threads = 1;
+	int i;
+
+	disassembler->error = MD_OK;
+	disassembler->error_message[0] = 0;
+#ifndef WINDOWS
+	pthread_once(&tables_initialized, init_tables);
+#else
+	InitOnceExecuteOnce(&tables_initialized, init_tables_once, 0, 0);
+#endif
+	report_progress(disassembler, "The disassembler compares the crazy operation with the digit by digit reference\nfor all 59049^2 pairs of operands. Please wait...");
+	memset(&check, 0, sizeof(struct CrazyCheck));
+#ifndef WINDOWS
+	{
+		pthread_t threads[MAX_EMITTER_THREADS];
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		if (processors > 1) {
+			number_of_threads = (processors > MAX_EMITTER_THREADS ? MAX_EMITTER_THREADS : (int)processors);
+		}
+		pthread_mutex_init(&check.lock, 0);
+		// this thread is a worker as well
+		for (i=1;i<number_of_threads;i++) {
+			if (pthread_create(&threads[i], 0, crazy_check_worker, &check) != 0) {
+				break;
+			}
+		}
+		number_of_threads = i;
+		crazy_check_worker(&check);
+		for (i=1;i<number_of_threads;i++) {
+			pthread_join(threads[i], 0);
+		}
+		pthread_mutex_destroy(&check.lock);
+	}
+#else
+	crazy_check_worker(&check);
+#endif
+	if (check.failed) {
+		report_progress(disassembler, " failed.\n");
+		return report_error(disassembler, MD_ERROR_DIVERGENCE, "crazy(%u, %u) is %u, the reference gives %u.",
+				check.a,check.d,crazy(check.a, check.d),crazy_digits(check.a, check.d));
+	}
+	report_progress(disassembler, " done.\nThe crazy operation agrees with the reference for all operands.\n");
+	return MD_OK;
+}
+
+unsigned int rotate_r(unsigned int d){
+	unsigned int carry = d%3;
+	d /= 3;
+	d += 19683 * carry;
+	return d;
+}
+
+
+int load_malbolge_program(struct Disassembler* disassembler, struct VMState* initial_state, const char* malbolge_file) {
+	unsigned int result;
+	FILE* file = 0;
+	struct TritWord previous, current;
+	
+	if (!initial_state || !malbolge_file) {
+		return 1;
+	}
+
+	report_progress(disassembler, "Loading Malbolge program...");
+
+	file = fopen(malbolge_file,"rb");
+	if (file == NULL) {
+		return report_error(disassembler, MD_ERROR_FILE, "File not found: %s",malbolge_file);
+	}
+	initial_state->a=0;
+	initial_state->c=0;
+	initial_state->d=0;
+	result = 0;
+	while (!feof(file) && initial_state->d < 59050){
+		unsigned int instr;
+		initial_state->memory[initial_state->d] = 0;
+		result = fread(initial_state->memory+initial_state->d,1,1,file);
+		if (result > 1) {
+			fclose(file);
+			return report_error(disassembler, MD_ERROR_FILE, "Cannot read file: %s",malbolge_file);
+		}
+		if (result == 0 || initial_state->memory[initial_state->d] == 0x1a || initial_state->memory[initial_state->d] == 0x04) {
+			break;
+		}
+		instr = initial_state->memory[initial_state->d];
+		if (instr == ' ' || instr == '\t' || instr == '\r' || instr == '\n') {
+			continue;
+		}else if (instr >= 33 && instr < 127 && xlat_cycle_table[instr-33][initial_state->d%94].valid) {
+			initial_state->d++;
+		}else{
+			fclose(file);
+			return report_error(disassembler, MD_ERROR_PROGRAM, "Invalid character 0x%02x at 0x%05x.",
+					(char)(initial_state->memory[initial_state->d]),initial_state->d); //invalid characters are not accepted.
+			//that makes the "hacked" in-out-program unrunnable
+			// TODO: give warning message and allow it here - this is a debugger, not an interpreter
+		}
+	}
+	fclose(file);
+	if (initial_state->d == 59050) {
+		return report_error(disassembler, MD_ERROR_PROGRAM, "Maximum program length of 59049 exceeded.");
+	}
+	if (initial_state->d < 2) {
+		return report_error(disassembler, MD_ERROR_PROGRAM, "Minimal program length of 2 deceeded.");
+	}
+
+	// the padding is a chain of crazy operations; keep the last two words as trits
+	previous = to_trits(initial_state->memory[initial_state->d-2]);
+	current = to_trits(initial_state->memory[initial_state->d-1]);
+	while (initial_state->d < 59049){
+		struct TritWord next = crazy_trits(current, previous);
+		initial_state->memory[initial_state->d] = from_trits(next);
+		previous = current;
+		current = next;
+		initial_state->d++;
+	}
+	initial_state->d = 0;
+
+	report_progress(disassembler, " done.\n");
+	return 0;
+}
+
+
+
+int find_entrypoint(struct Disassembler* disassembler, struct VMState* entry_state, long long* steps_to_entrypoint, const struct VMState* initial_state, int use_jit,
+		struct EventTrace* pre_entry_events) {
+	struct VMState* tmp_state = 0;
+	struct TraceCache* cache = 0;
+	struct BreakCondition break_on = {0, 0, MALBOLGE_IN | MALBOLGE_OUT};
+	long long steps = 0;
+	if (!initial_state) {
+		return 1;
+	}
+	tmp_state = (VMState*)malloc(sizeof(VMState));
+	cache = create_trace_cache(use_jit);
+	if (!tmp_state || !cache) {
+		free(tmp_state);
+		free_trace_cache(cache);
+		return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+	report_progress(disassembler, "\nMalbolge disassembler tries to find the entry point...");
+	copy_state(tmp_state,initial_state);
+
+	// TODO: prevent from infinite loop; maybe set a maximum number of steps and ask what to do whenever the maximum number is reached
+	// record this run for optimize_entrypoint; it contains the run to the entry point
+	begin_event_trace_run(pre_entry_events, tmp_state);
+	execute_traced(cache, tmp_state, 0, break_on, &steps, 0, pre_entry_events);
+	end_event_trace_run(pre_entry_events);
+	if (out_of_budget()) {
+		free_trace_cache(cache);
+		free(tmp_state);
+		return report_error(disassembler, MD_ERROR_BUDGET, "The budget has been exhausted before the entry point has been found.");
+	}
+	// execute until entry point (which is last JMP before first IN/OUT/HLT command)
+	copy_state(tmp_state,initial_state);
+	break_on.maximal_steps = steps;
+	break_on.on_cseg_outside_analysis = 0;
+	break_on.command_mask = 0;
+	if (steps > 0) {
+		// the run has been executed before
+		disassembler->budget_enforced = 0;
+		execute_traced(cache, tmp_state, 0, break_on, 0, 0, 0);
+		disassembler->budget_enforced = 1;
+	}
+	free_trace_cache(cache);
+	if (!(tmp_state->memory[tmp_state->c] >= 33 && tmp_state->memory[tmp_state->c] <= 126 && instruction_table[tmp_state->memory[tmp_state->c]-33][tmp_state->c%94] == 4)) {
+		// no JMP command at entry point position
+		free(tmp_state);
+		return report_error(disassembler, MD_ERROR_ENTRY_POINT, "Failed to find the entry point.");
+	}
+	if (steps_to_entrypoint) {
+		*steps_to_entrypoint = steps;
+	}
+	if (entry_state) {
+		copy_state(entry_state,tmp_state);
+	}
+	free(tmp_state);
+	report_progress(disassembler, " done.\nEntry point found at step %lld.\n",*steps_to_entrypoint);
+	return 0;
+}
+
+
+
+// saves the input of an interactive run to <transcript_prefix>-<run>.in, so it can be replayed as input file later.
+// output is the hashed output of the run if it has halted; the replay compares its output with it.
+void save_interactive_transcript(struct Disassembler* disassembler, const struct UserInput* input, const struct OutputSink* output, int run) {
+	char* filename;
+	if (!disassembler->transcript_prefix) {
+		return;
+	}
+	filename = (char*)malloc(strlen(disassembler->transcript_prefix)+16+strlen(TRANSCRIPT_FILE_EXTENSION));
+	if (!filename) {
+		return;
+	}
+	sprintf(filename, "%s-%d.%s", disassembler->transcript_prefix, run, TRANSCRIPT_FILE_EXTENSION);
+	if (save_transcript_file(filename, input, output)) {
+		report_progress(disassembler, "Cannot save the input of this run to %s.\n", filename);
+	}else{
+		report_progress(disassembler, "The input of this run has been saved to %s.\n", filename);
+	}
+	free(filename);
+}
+
+int interactive_access_analysis(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, struct CoverageLimits limits) {
+	int action = 0;
+	int run = 0;
+	struct VMState* tmp_state = 0;
+	struct SigintHandler handler;
+	if (!entry_state || !accesses) {
+		return 1;
+	}
+	tmp_state = (VMState*)malloc(sizeof(VMState));
+	if (!tmp_state) {
+		return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+	// ask user for help to generate different runs of the Malbolge program
+	report_progress(disassembler, "\nThe disassembler needs to identify the memory cells that are ever used.\n");
+	report_progress(disassembler, "Therefore the disassembler will execute the Malbolge program now.\n");
+	report_progress(disassembler, "Please interact with the Malbolge program if it asks for input.\n");
+	report_progress(disassembler, "You can interrupt execution of the Malbolge program and continue disassembling\nby pressing CTRL+C anytime.\n");
+	report_progress(disassembler, "Note that it is mandatory for disassembling that every branch of the Malbolge\nprogram will be entered.\n");
+	report_progress(disassembler, "Because of that, Malbolge disassembler allows you to run the Malbolge program\nmultiple times with different input each.\n\n");
+	report_progress(disassembler, "Press return to start the Malbolge program execution.\n");
+	do {
+		int in = getchar();
+		if (in == EOF) {
+			free(tmp_state);
+			return report_error(disassembler, MD_ERROR_CANCELED, "Canceled by the user.");
+		}
+		if ((char)in == '\n') {
+			break; // return pressed
+		}
+	}while(1);
+
+	if (install_sigint_handler(disassembler, &handler)) {
+		free(tmp_state);
+		return report_error(disassembler, MD_ERROR_SYSTEM, "Cannot set CTRL handler.");
+	}
+	reset_access_analysis(accesses);
+	set_coverage_limits(accesses, limits);
+	do {
+		int interrupted = 0;
+		struct BreakCondition break_on = {0, 0, 0};
+		struct UserInput input = {0, 0, 0, 0};
+		long long steps = 0;
+		int truncated = accesses->coverage_truncated;
+		report_progress(disassembler, "Running Malbolge program...\n");
+		copy_state(tmp_state,entry_state);
+		restart_output_hash(disassembler->terminal_output);
+		steps = execute(tmp_state, 1, &input, break_on, 0, &interrupted, accesses, 0, 0);
+		if (steps > accesses->maximal_steps_from_entry_point) {
+			accesses->maximal_steps_from_entry_point = steps;
+		}
+		if (accesses->error) {
+			free_user_input(&input);
+			restore_sigint_handler(&handler);
+			free(tmp_state);
+			return report_error(disassembler, accesses->error, "Not enough memory.");
+		}
+		truncated = accesses->coverage_truncated & ~truncated;
+		report_progress(disassembler, "\nMalbolge program %s %lld steps behind entry point.\n",
+				interrupted?"interrupted":((truncated || out_of_budget())?"stopped":"terminated"),steps);
+		if (truncated) {
+			print_coverage_truncation(disassembler, truncated, limits);
+		}
+		run++;
+		if (input.length > 0 || input.eof) {
+			save_interactive_transcript(disassembler, &input, (!interrupted && has_halted(tmp_state)) ? disassembler->terminal_output : 0, run);
+		}
+		if ((accesses->coverage_truncated & DEADLINE_REACHED) || out_of_budget()) {
+			// no further runs
+			free_user_input(&input);
+			break;
+		}
+		if (input.length == 0 && !input.eof && !interrupted) {
+			// no interaction
+			free_user_input(&input);
+			report_progress(disassembler, "Malbolge program terminated without user interaction. No further run is\nnecessary.\n");
+			break;
+		}
+		free_user_input(&input);
+		report_progress(disassembler, "Do you want to execute the Malbolge program again? [Y/n] ");
+			action = -1;
+		do {
+			int in = getchar();
+			if (in == EOF) {
+				restore_sigint_handler(&handler);
+				free(tmp_state);
+				return report_error(disassembler, MD_ERROR_CANCELED, "Canceled by the user.");
+			}
+			if ((char)in == '\n') {
+				if (action == -1)
+					action = 1;
+				break; // return pressed
+			}
+			if (action == -1 && ((char)in == 'n' || (char)in == 'N')) {
+				action = 0;
+			} else {
+				action = 1;
+			}
+		}while(1);
+	}while(action);
+	restore_sigint_handler(&handler);
+	// later runs must not be truncated
+	memset(&accesses->limits, 0, sizeof(struct CoverageLimits));
+	accesses->deadline = 0;
+	free(tmp_state);
+	return 0;
+}
+
+void set_coverage_limits(struct AccessAnalysis* accesses, struct CoverageLimits limits) {
+	accesses->limits = limits;
+	accesses->deadline = 0;
+	if (limits.deadline_seconds > 0) {
+		accesses->deadline = time(0) + limits.deadline_seconds;
+	}
+}
+
+void print_coverage_truncation(struct Disassembler* disassembler, int truncated, struct CoverageLimits limits) {
+	if (truncated & COVERAGE_SATURATED) {
+		report_progress(disassembler, "No new memory access information has been found for");
+		if (limits.window_steps > 0) {
+			report_progress(disassembler, " %d steps",limits.window_steps);
+		}
+		if (limits.window_steps > 0 && limits.window_seconds > 0) {
+			report_progress(disassembler, " or");
+		}
+		if (limits.window_seconds > 0) {
+			report_progress(disassembler, " %d second%s",limits.window_seconds,limits.window_seconds==1?"":"s");
+		}
+		report_progress(disassembler, ".\n");
+	}
+	if (truncated & DEADLINE_REACHED) {
+		report_progress(disassembler, "The deadline of %d second%s has been reached.\n",limits.deadline_seconds,limits.deadline_seconds==1?"":"s");
+	}
+}
+
+
+int optimize_entrypoint(struct Disassembler* disassembler, struct VMState* entry_state, long long* steps_to_entrypoint, struct AccessAnalysis* accesses,
+		const struct VMState* initial_state, int use_jit, struct EventTrace* pre_entry_events) {
+	if (!entry_state || !steps_to_entrypoint || !accesses || !initial_state) {
+		return 1;
+	}
+
+	if (out_of_budget()) {
+		report_progress(disassembler, "The entry point is not optimized, because the budget has been exhausted.\n");
+		return 0;
+	}
+	// test whether jmp command of entry point lies inside the Malbolge program (accessed as CREG_EXECUTED later)
+	if (accesses->access[entry_state->c] & CREG_EXECUTED) {
+		struct BreakCondition break_on = {0, 0, 0};
+		long long optimized_entry_steps = 0;
+		long long steps_in_trace = -1;
+		int old_a_register_matters = 0;
+		int old_a_register_decided = 0;
+		struct VMState* optimized_entry_state = 0;
+		struct AccessAnalysis* tmp_accesses = 0;
+		struct TraceCache* cache = 0;
+		struct EventTraceReader reader;
+		long long steps = 0;
+		
+		optimized_entry_state = (VMState*)malloc(sizeof(VMState));
+		tmp_accesses = (AccessAnalysis*)malloc(sizeof(AccessAnalysis));
+		cache = create_trace_cache(use_jit);
+	
+		if (!optimized_entry_state || !tmp_accesses || !cache) {
+			report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+			if (optimized_entry_state) {
+				free(optimized_entry_state);
+				optimized_entry_state = 0;
+			}
+			if (tmp_accesses) {
+				free(tmp_accesses);
+				tmp_accesses = 0;
+			}
+			free_trace_cache(cache);
+			return 1;
+		}
+
+		report_progress(disassembler, "\nNow Malbolge disassembler tries to find a better entry point.\n");
+		report_progress(disassembler, "This may take some time. Please wait...");
+			// optimize entry point
+
+		// optimized entry point: start with zero.
+		// Malbolge program: start fresh from file, run at most as many steps as needed to reach the known entry-point
+		// whenever a CSEG-command outside the AccessAnalysis (make a tmp copy!) is executed, set the new optimized entry point at the next JMP behind this value
+		// (or AT this value if it is a JMP instruction)
+		copy_state(optimized_entry_state,initial_state);
+		copy_access_analysis(tmp_accesses, accesses);
+
+		// find_entrypoint has recorded the run to the entry point; reading it is much faster than executing it again
+		if (pre_entry_events && !pre_entry_events->failed && !open_event_trace_file(&reader, pre_entry_events->file)) {
+			steps_in_trace = find_optimized_entrypoint_in_trace(&reader, *steps_to_entrypoint, tmp_accesses);
+			close_event_trace_reader(&reader);
+		}
+		if (steps_in_trace >= 0) {
+			optimized_entry_steps = steps_in_trace;
+		}else do {
+			break_on.maximal_steps = *steps_to_entrypoint - optimized_entry_steps;
+			break_on.on_cseg_outside_analysis = 1;
+			break_on.command_mask = 0;
+			steps += execute(optimized_entry_state, 0, 0, break_on, 0, 0, tmp_accesses, 1, 0);
+			if (*steps_to_entrypoint <= optimized_entry_steps + steps) {
+				// entry point found!
+				break;
+			}
+			if (out_of_budget()) {
+				// keep the entry point
+				optimized_entry_steps = *steps_to_entrypoint;
+				break;
+			}
+			break_on.maximal_steps = *steps_to_entrypoint - optimized_entry_steps - steps;
+			break_on.on_cseg_outside_analysis = 0;
+			break_on.command_mask = MALBOLGE_JMP;
+			steps += execute_traced(cache, optimized_entry_state, 0, break_on, 0, 0, 0);
+			if (out_of_budget()) {
+				optimized_entry_steps = *steps_to_entrypoint;
+				break;
+			}
+			optimized_entry_steps += steps;
+			steps = 0;
+			break_on.maximal_steps = 1;
+			break_on.on_cseg_outside_analysis = 0;
+			break_on.command_mask = 0;
+			steps += execute(optimized_entry_state, 0, 0, break_on, 0, 0, 0, 0, 0);
+		}while(1);
+		free_access_analysis(tmp_accesses);
+
+		report_progress(disassembler, " done.\n");
+
+		// update accesses and entry_state if necessary...
+		if (optimized_entry_steps < *steps_to_entrypoint) {
+			report_progress(disassembler, "Earlier entry point found at step %lld.\n",optimized_entry_steps);
+			report_progress(disassembler, "Malbolge disassembler is updating memory access information for the new\nentry point. Please wait...");
+			// update acces information. these runs are bounded by the old entry point and must not be stopped.
+			disassembler->budget_enforced = 0;
+			// at first: go to new entry point. at step 0 it is the initial state; a run with maximal_steps 0 would not stop.
+			copy_state(optimized_entry_state,initial_state);
+			if (optimized_entry_steps > 0) {
+				break_on.maximal_steps = optimized_entry_steps;
+				break_on.on_cseg_outside_analysis = 0;
+				break_on.command_mask = 0;
+				execute_traced(cache, optimized_entry_state, 0, break_on, 0, 0, 0);
+			}
+			// now update access information starting here
+			copy_state(entry_state,optimized_entry_state);
+			break_on.maximal_steps = *steps_to_entrypoint - optimized_entry_steps + 1; // +1: the JMP at the old entry point has to be added!
+			break_on.on_cseg_outside_analysis = 0;
+			break_on.command_mask = 0;
+			// the A register is decided by this run now, unless it reaches the old entry point before.
+			// in that case the decision of the run from the old entry point remains valid.
+			old_a_register_matters = accesses->a_register_matters;
+			old_a_register_decided = accesses->a_register_decided;
+			accesses->a_register_matters = 0;
+			accesses->a_register_decided = 0;
+			accesses->start_step = optimized_entry_steps;
+			execute(optimized_entry_state, 0, 0, break_on, 0, 0, accesses, 0, 0);
+			if (!accesses->a_register_decided) {
+				accesses->a_register_matters = old_a_register_matters;
+				accesses->a_register_decided = old_a_register_decided;
+			}
+			accesses->maximal_steps_from_entry_point += *steps_to_entrypoint - optimized_entry_steps; // update maximal user-steps from entrypoint
+			*steps_to_entrypoint = optimized_entry_steps;
+			accesses->start_step = optimized_entry_steps;
+			disassembler->budget_enforced = 1;
+			report_progress(disassembler, " done.\n");
+		}else{
+			report_progress(disassembler, "No better entry point has been found.\n");
+		}
+		free(optimized_entry_state);
+		free(tmp_accesses);
+		free_trace_cache(cache);
+		if (accesses->error) {
+			return report_error(disassembler, accesses->error, "Not enough memory.");
+		}
+	}else{
+		report_progress(disassembler, "The entry point seems to be optimal.\n");
+	}
+	return 0;
+}
+
+
+
+int extract_codeblocks(struct Disassembler* disassembler, struct ConnectedMemoryCells** creg_components, struct ConnectedMemoryCells** dreg_components,
+		struct AccessAnalysis* accesses, const struct FlowGraph* graph, const struct VMState* entry_state, int use_jit) {
+
+	struct BreakCondition break_on = {0, 0, 0};
+	int i = 0;
+	VMState* tmp_state = 0;
+	struct TraceCache* cache = 0;
+	struct avl_table* ever_used_memory_cells = 0;
+	int number_creg_components = 0; // to avoid counting its size again and again
+	int number_dreg_components = 0; // to avoid counting its size again and again
+	
+	if (!creg_components || !dreg_components || !accesses || !graph) {
+		return 1;
+	}
+
+	tmp_state = (VMState*)malloc(sizeof(VMState));
+	if (!tmp_state) {
+		report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+		return 1;
+	}
+	
+	// FIXED_OFFSET and a_register_matters have been set while the access analysis has been running.
+	report_progress(disassembler, "Malbolge disassembler processes memory access information now.\nPlease wait...");
+	if (!accesses->a_register_decided) {
+		// the analysis runs have been interrupted before: run through program until OUT, OPR, IN, ROT, HLT
+		// use accesses->maximal_steps_from_entry_point to prevent hanging in (senseless) endless-loops
+		// not necessary at the moment, because entry-point guarantees IN or OUT operation.
+		// But if the entry point-detection is changed, this makes sure that endless loops will not occur here.
+		copy_state(tmp_state,entry_state);
+		break_on.maximal_steps = accesses->maximal_steps_from_entry_point;
+		break_on.on_cseg_outside_analysis = 0;
+		break_on.command_mask = MALBOLGE_HLT | MALBOLGE_OPR | MALBOLGE_OUT | MALBOLGE_IN | MALBOLGE_ROT;
+		cache = create_trace_cache(use_jit);
+		if (!cache) {
+			report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+			free(tmp_state);
+			return 1;
+		}
+		disassembler->budget_enforced = 0;
+		execute_traced(cache, tmp_state, 0, break_on, 0, 0, 0);
+		disassembler->budget_enforced = 1;
+		free_trace_cache(cache);
+		// check whether tmp_state.c points to OUT or OPR.
+		if (tmp_state->memory[tmp_state->c] >= 33 && tmp_state->memory[tmp_state->c] <= 126 &&
+				(instruction_table[tmp_state->memory[tmp_state->c]-33][tmp_state->c%94] == 5 || instruction_table[tmp_state->memory[tmp_state->c]-33][tmp_state->c%94] == 62)) {
+			// the A register matters
+			accesses->a_register_matters = 1;
+		}
+		accesses->a_register_decided = 1;
+	}
+
+	// go through access-array and find conneted blocks
+
+
+	// extract and store memory cells ever used
+	ever_used_memory_cells = avl_create(compare_integer, 0, &avl_allocator_default);
+	if (!ever_used_memory_cells) {
+		report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+		free(tmp_state);
+		return 1;
+	}
+	// fill ever_used_memory_cells according to AccessAnalysis.
+	for (i=0;i<59049;i++) {
+		unsigned long long flags;
+		if (!(i & 3) && i+4 <= 59049) {
+			// most cells are never used: test the flags of 4 cells at once
+			memcpy(&flags, accesses->access+i, sizeof(flags));
+			if (!flags) {
+				i += 3;
+				continue;
+			}
+		}
+		if (accesses->access[i]) {
+			int* cell_id = (int*)malloc(sizeof(int));
+			if (!cell_id) {
+				report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+				free(tmp_state);
+				return 1;
+			}
+			*cell_id = i;
+			avl_insert(ever_used_memory_cells, cell_id);
+		}
+	}
+
+	*creg_components = (struct ConnectedMemoryCells*)malloc(sizeof(struct ConnectedMemoryCells)); // zero-terminated
+	*dreg_components = (struct ConnectedMemoryCells*)malloc(sizeof(struct ConnectedMemoryCells)); // zero-terminated
+	if (!*creg_components || !*dreg_components) {
+		report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+		free(tmp_state);
+		return 1;
+	}
+	memset(*creg_components,0,sizeof(struct ConnectedMemoryCells));
+	memset(*dreg_components,0,sizeof(struct ConnectedMemoryCells));
+
+	// while ever_used_memory_cells is no empty
+	while (ever_used_memory_cells->avl_count != 0) {
+		//take first cell and build a new connected memory block:
+		struct avl_traverser it;
+		//avl_t_init(&it, ever_used_memory_cells);
+		struct ConnectedMemoryCells current_memory_block;
+		struct avl_table* block_cells = 0;
+		struct avl_table* cells_to_be_added = 0;
+		int* first_cell = (int*)avl_t_first(&it, ever_used_memory_cells);
+		if (!first_cell) {
+			report_error(disassembler, MD_ERROR_INTERNAL, "Error accessing AVL tree.");
+			free(tmp_state);
+			return 1;
+		}
+		// initialize new connected memory block
+		memset(&current_memory_block, 0, sizeof(ConnectedMemoryCells));
+		block_cells = avl_create(compare_integer, 0, &avl_allocator_default);
+		if (!block_cells) {
+			report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+			free(tmp_state);
+			return 1;
+		}
+		// list of elements to be added in future
+		cells_to_be_added = avl_create(compare_integer, 0, &avl_allocator_default);
+		if (!cells_to_be_added) {
+			report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+			free(tmp_state);
+			return 1;
+		}
+		// first_cell should be added to current memory block, then it need not be processed for further blocks
+		avl_insert(cells_to_be_added, first_cell);
+		avl_delete(ever_used_memory_cells, first_cell);
+		while (cells_to_be_added->avl_count != 0) {
+			//take first cell of cells_to_be_added
+			//avl_t_init(&it, cells_to_be_added);
+			int* add_cell = (int*)avl_t_first(&it, cells_to_be_added);
+			if (!add_cell) {
+				report_error(disassembler, MD_ERROR_INTERNAL, "Error accessing AVL tree.");
+				free(tmp_state);
+				return 1;
+			}
+			// find all successors and predecessors,
+			//		add them to cells_to_be_added (if not added to any memory block yet), remove them from ever_used_memory_cells
+			if (accesses->access[*add_cell] & CREG_REACHED_WO_JMP) {
+				// add preceeding cell to cells_to_be_added, delete it from ever_used_memory_cells
+				int prec = (*add_cell) - 1;
+				void* tmp = 0;
+				if (prec < 0) {
+					// underflow; offsets should be fixed.
+					// note that fixing offsets is ot necessary due to the malbolge program itself
+					// but the way the .CODE or .DATA section will be printed out later requires
+					// fixed offsets to work. otherwse the connected component would break.
+					current_memory_block.fixed_offset = 1;
+					prec = 59048;
+				}
+				tmp = avl_delete(ever_used_memory_cells,&prec);
+				if (tmp) {
+					avl_insert(cells_to_be_added, tmp);
+				}
+			}
+			if (accesses->access[*add_cell] & CREG_TRANSLATED) {
+				// add succeeding cell to cells_to_be_added, delete it from ever_used_memory_cells
+				int succ = (*add_cell) + 1;
+				void* tmp = 0;
+				if (succ > 59048) {
+					// overflow; offsets should be fixed. (see above)
+					current_memory_block.fixed_offset = 1;
+					succ = 0;
+				}
+				tmp = avl_delete(ever_used_memory_cells,&succ);
+				if (tmp) {
+					avl_insert(cells_to_be_added, tmp);
+				}
+			}
+			// go through normal flow successors
+			for (i=graph->edges[FLOW_SUCCESSORS].offsets[*add_cell];i<graph->edges[FLOW_SUCCESSORS].offsets[*add_cell+1];i++) {
+				int cell = graph->edges[FLOW_SUCCESSORS].targets[i];
+				void* tmp = 0;
+				if (cell < *add_cell) {
+					// overflow; offsets should be fixed. (see above)
+					current_memory_block.fixed_offset = 1;
+				}
+				tmp = avl_delete(ever_used_memory_cells,&cell);
+				if (tmp) {
+					avl_insert(cells_to_be_added, tmp);
+				}
+			}
+			// go through normal flow predecessors
+			for (i=graph->edges[FLOW_PREDECESSORS].offsets[*add_cell];i<graph->edges[FLOW_PREDECESSORS].offsets[*add_cell+1];i++) {
+				int cell = graph->edges[FLOW_PREDECESSORS].targets[i];
+				void* tmp = 0;
+				if (cell > *add_cell) {
+					// underflow; offsets should be fixed. (see above)
+					current_memory_block.fixed_offset = 1;
+				}
+				tmp = avl_delete(ever_used_memory_cells,&cell);
+				if (tmp) {
+					avl_insert(cells_to_be_added, tmp);
+				}
+			}
+
+			//add first cell to current_memory_block, update current_memory_block's flags etc., delete cell from cells_to_be_added
+			if (accesses->access[*add_cell] & (CREG_TRANSLATED | CREG_REACHED_WO_JMP | CREG_EXECUTED | CREG_REACHED_BY_JMP)) {
+				// set CREG-Flag in current connected block
+				current_memory_block.codesection = 1;
+			}
+			if (accesses->access[*add_cell] & (DREG_ACCESS_MOVD | DREG_ACCESS_JUMP | DREG_ACCESS_RW | DREG_REACHED_BY_MOVD)) {
+				// set DREG-Flag in current connected block
+				current_memory_block.datasection = 1;
+			}
+			if (accesses->access[*add_cell] & FIXED_OFFSET) {
+				// set FIXED_OFFSET-Flag in current connected block
+				current_memory_block.fixed_offset = 1;
+			}
+
+			avl_delete(cells_to_be_added, add_cell);
+			avl_insert(block_cells, add_cell);
+		}
+		avl_destroy(cells_to_be_added, 0);
+		if (set_circular_cell_order(&current_memory_block, block_cells)) {
+			report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+			free(tmp_state);
+			return 1;
+		}
+		//check whether memory_block is a creg or dreg element;
+		if (current_memory_block.datasection && current_memory_block.codesection) {
+			// if not unique, use it inside data-section (more flexible), but with fixed offset
+			current_memory_block.codesection = 0;
+			current_memory_block.fixed_offset = 1;
+		}
+		//add current_memory_block to creg_components or dreg_components;
+		if (current_memory_block.datasection) {
+			// add to datasection
+			struct ConnectedMemoryCells* tmp = (struct ConnectedMemoryCells*)realloc(
+					*dreg_components, sizeof(struct ConnectedMemoryCells)*(number_dreg_components+2)); // zero-terminated
+			if (!tmp) {
+				report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+				free(tmp_state);
+				return 1;
+			}
+			*dreg_components = tmp;
+			memcpy(*dreg_components+number_dreg_components, &current_memory_block, sizeof(struct ConnectedMemoryCells));
+			number_dreg_components++;
+			memset(*dreg_components+number_dreg_components,0,sizeof(struct ConnectedMemoryCells));
+		} else if (current_memory_block.codesection) {
+			// add to codesection
+			struct ConnectedMemoryCells* tmp = (struct ConnectedMemoryCells*)realloc(
+					*creg_components, sizeof(struct ConnectedMemoryCells)*(number_creg_components+2)); // zero-terminated
+			if (!tmp) {
+				report_error(disassembler, MD_ERROR_MEMORY, "Cannot allocate memory.");
+				free(tmp_state);
+				return 1;
+			}
+			*creg_components = tmp;
+			memcpy(*creg_components+number_creg_components, &current_memory_block, sizeof(struct ConnectedMemoryCells));
+			number_creg_components++;
+			memset(*creg_components+number_creg_components,0,sizeof(struct ConnectedMemoryCells));
+		} else {
+			// why were current_memory_block's cells ever added to ever_used_index?
+			report_progress(disassembler, "\nWarning: Internal error occured. Output may be incorrect or even invalid.\n");
+		}
+	}
+	// done.
+	avl_destroy(ever_used_memory_cells, 0);
+	free(tmp_state);
+	report_progress(disassembler, " done.\n");
+	return 0;
+}
+
+
+// returns the edge sets of cell for reading or 0 if no edge of the cells around has been added yet.
+const struct MemoryCellInfo* find_cell_edge_sets(const struct AccessAnalysis* accesses, int cell) {
+	const struct EdgeSetPage* page = accesses->edge_sets[cell / EDGE_SET_PAGE_CELLS];
+	if (!page) {
+		return 0;
+	}
+	return &page->cells[cell % EDGE_SET_PAGE_CELLS];
+}
+
+// returns the edge sets of cell for writing. pages are allocated on first use;
+// a page shared with a copy of the AccessAnalysis is copied before it is modified.
+// returns 0 and sets accesses->error if there is not enough memory.
+struct MemoryCellInfo* cell_edge_sets(struct AccessAnalysis* accesses, int cell) {
+	struct EdgeSetPage** page = &accesses->edge_sets[cell / EDGE_SET_PAGE_CELLS];
+	if (!*page) {
+		*page = (struct EdgeSetPage*)calloc(1, sizeof(struct EdgeSetPage));
+		if (!*page) {
+			accesses->error = MD_ERROR_MEMORY;
+			return 0;
+		}
+		(*page)->references = 1;
+		accesses->memory += sizeof(struct EdgeSetPage);
+	}else if ((*page)->references > 1) {
+		struct EdgeSetPage* copy = copy_edge_set_page(*page);
+		int i, kind;
+		if (!copy) {
+			accesses->error = MD_ERROR_MEMORY;
+			return 0;
+		}
+		accesses->memory += sizeof(struct EdgeSetPage);
+		for (i=0;i<EDGE_SET_PAGE_CELLS;i++) {
+			for (kind=0;kind<FLOW_GRAPH_KINDS;kind++) {
+				struct avl_table* set = *edge_set_of_kind(&copy->cells[i], kind);
+				if (set) {
+					accesses->memory += set->avl_count * EDGE_MEMORY;
+				}
+			}
+		}
+		(*page)->references--;
+		*page = copy;
+	}
+	return &(*page)->cells[cell % EDGE_SET_PAGE_CELLS];
+}
+
+void* copy_integer(void* avl_item, void* avl_param) {
+	int* copy = (int*)malloc(sizeof(int));
+	if (copy) {
+		*copy = *(int*)avl_item;
+	}
+	return copy;
+}
+
+void free_integer(void* avl_item, void* avl_param) {
+	free(avl_item);
+}
+
+struct avl_table** edge_set_of_kind(struct MemoryCellInfo* cell, int kind) {
+	if (kind == FLOW_SUCCESSORS) {
+		return &cell->dreg_successors_normal_flow;
+	}else if (kind == FLOW_PREDECESSORS) {
+		return &cell->dreg_predecessors_normal_flow;
+	}else if (kind == FLOW_JMP_DESTINATIONS) {
+		return &cell->dreg_jmp_destinations;
+	}else{
+		return &cell->dreg_movd_destinations;
+	}
+}
+
+// deep copy of a page with a reference count of 1
+struct EdgeSetPage* copy_edge_set_page(const struct EdgeSetPage* page) {
+	struct EdgeSetPage* copy = (struct EdgeSetPage*)calloc(1, sizeof(struct EdgeSetPage));
+	int i, kind;
+	if (!copy) {
+		return 0;
+	}
+	copy->references = 1;
+	for (i=0;i<EDGE_SET_PAGE_CELLS;i++) {
+		for (kind=0;kind<FLOW_GRAPH_KINDS;kind++) {
+			struct avl_table* set = *edge_set_of_kind((struct MemoryCellInfo*)&page->cells[i], kind);
+			struct avl_table** set_copy = edge_set_of_kind(&copy->cells[i], kind);
+			if (!set) {
+				continue;
+			}
+			*set_copy = avl_copy(set, copy_integer, free_integer, &avl_allocator_default);
+			if (!*set_copy) {
+				release_edge_set_page(copy);
+				return 0;
+			}
+		}
+	}
+	return copy;
+}
+
+// drops a reference to page; the page is freed with the last one
+void release_edge_set_page(struct EdgeSetPage* page) {
+	int i, kind;
+	if (!page || --page->references > 0) {
+		return;
+	}
+	for (i=0;i<EDGE_SET_PAGE_CELLS;i++) {
+		for (kind=0;kind<FLOW_GRAPH_KINDS;kind++) {
+			struct avl_table* set = *edge_set_of_kind(&page->cells[i], kind);
+			if (set) {
+				avl_destroy(set, free_integer);
+			}
+		}
+	}
+	free(page);
+}
+
+void add_dreg_normal_successor(struct AccessAnalysis* accesses, int cell, int successor) {
+	struct MemoryCellInfo* sets = 0;
+	int* succ = 0;
+	int* old = 0;
+	if (!accesses) {
+		return;
+	}
+	if (cell < 0 || cell >= 59049 || successor < 0 || successor >= 59049) {
+		return;
+	}
+	sets = cell_edge_sets(accesses, cell);
+	if (!sets) {
+		return;
+	}
+
+	if (sets->dreg_successors_normal_flow == 0) {
+		sets->dreg_successors_normal_flow = avl_create(compare_integer, 0, &avl_allocator_default);
+	}
+	if (sets->dreg_successors_normal_flow == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	succ = (int*)malloc(sizeof(int));
+	if (succ == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	*succ = successor;
+	old = avl_insert(sets->dreg_successors_normal_flow, succ);
+	if (old) {
+		free(succ);
+	}else{
+		accesses->coverage++;
+		accesses->memory += EDGE_MEMORY;
+	}
+}
+
+
+void add_dreg_normal_predecessors(struct AccessAnalysis* accesses, int cell, int predecessor) {
+	struct MemoryCellInfo* sets = 0;
+	int* pred = 0;
+	int* old = 0;
+	if (!accesses) {
+		return;
+	}
+	if (cell < 0 || cell >= 59049 || predecessor < 0 || predecessor >= 59049) {
+		return;
+	}
+	sets = cell_edge_sets(accesses, cell);
+	if (!sets) {
+		return;
+	}
+
+	if (sets->dreg_predecessors_normal_flow == 0) {
+		sets->dreg_predecessors_normal_flow = avl_create(compare_integer, 0, &avl_allocator_default);
+	}
+	if (sets->dreg_predecessors_normal_flow == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	pred = (int*)malloc(sizeof(int));
+	if (pred == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	*pred = predecessor;
+	old = avl_insert(sets->dreg_predecessors_normal_flow, pred);
+	if (old) {
+		free(pred);
+	}else{
+		accesses->coverage++;
+		accesses->memory += EDGE_MEMORY;
+	}
+}
+
+
+
+void add_jmp_destination(struct AccessAnalysis* accesses, int cell, int destination) {
+	struct MemoryCellInfo* sets = 0;
+	int* old = 0;
+	int* dest = 0;
+	if (!accesses) {
+		return;
+	}
+	if (cell < 0 || cell >= 59049 || destination < 0 || destination >= 59049) {
+		return;
+	}
+	sets = cell_edge_sets(accesses, cell);
+	if (!sets) {
+		return;
+	}
+
+	if (sets->dreg_jmp_destinations == 0) {
+		sets->dreg_jmp_destinations = avl_create(compare_integer, 0, &avl_allocator_default);
+	}
+	if (sets->dreg_jmp_destinations == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	dest = (int*)malloc(sizeof(int));
+	if (dest == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	*dest = destination;
+	old = avl_insert(sets->dreg_jmp_destinations, dest);
+	if (old) {
+		free(dest);
+	}else{
+		accesses->coverage++;
+		accesses->memory += EDGE_MEMORY;
+		if (accesses->access[cell] & DREG_ACCESS_RW) {
+			// the cell is modified during execution, so the successor of its destination must keep its offset
+			accesses->access[(destination+1)%59049] |= FIXED_OFFSET;
+		}
+	}
+}
+
+void add_movd_destination(struct AccessAnalysis* accesses, int cell, int destination) {
+	struct MemoryCellInfo* sets = 0;
+	int* dest = 0;
+	int* old = 0;
+	if (!accesses) {
+		return;
+	}
+	if (cell < 0 || cell >= 59049 || destination < 0 || destination >= 59049) {
+		return;
+	}
+	sets = cell_edge_sets(accesses, cell);
+	if (!sets) {
+		return;
+	}
+
+	if (sets->dreg_movd_destinations == 0) {
+		sets->dreg_movd_destinations = avl_create(compare_integer, 0, &avl_allocator_default);
+	}
+	if (sets->dreg_movd_destinations == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	dest = (int*)malloc(sizeof(int));
+	if (dest == 0) {
+		accesses->error = MD_ERROR_MEMORY;
+		return;
+	}
+	*dest = destination;
+	old = avl_insert(sets->dreg_movd_destinations, dest);
+	if (old) {
+		free(dest);
+	}else{
+		accesses->coverage++;
+		accesses->memory += EDGE_MEMORY;
+		if (accesses->access[cell] & DREG_ACCESS_RW) {
+			// the cell is modified during execution, so the successor of its destination must keep its offset
+			accesses->access[(destination+1)%59049] |= FIXED_OFFSET;
+		}
+	}
+}
+
+void add_access_flag(struct AccessAnalysis* accesses, int cell, int flag) {
+	if (!(accesses->access[cell] & flag)) {
+		accesses->access[cell] |= flag;
+		accesses->coverage++;
+	}
+}
+
+int init_edge_log(struct EdgeLog* edges) {
+	int i;
+	edges->entries = (unsigned long long*)malloc(sizeof(unsigned long long)*EDGE_LOG_CAPACITY);
+	edges->scratch = (unsigned long long*)malloc(sizeof(unsigned long long)*EDGE_LOG_CAPACITY);
+	edges->recent = (unsigned long long*)malloc(sizeof(unsigned long long)*RECENT_EDGES);
+	if (!edges->entries || !edges->scratch || !edges->recent) {
+		if (edges->entries) {
+			free(edges->entries);
+		}
+		if (edges->scratch) {
+			free(edges->scratch);
+		}
+		if (edges->recent) {
+			free(edges->recent);
+		}
+		memset(edges, 0, sizeof(struct EdgeLog));
+		return 1;
+	}
+	for (i=0;i<RECENT_EDGES;i++) {
+		edges->recent[i] = EDGE_NONE;
+	}
+	edges->length = 0;
+	return 0;
+}
+
+// inserts an edge into the sets of the AccessAnalysis
+void apply_edge(struct AccessAnalysis* accesses, unsigned long long edge) {
+	int kind = (int)(edge >> 32);
+	int cell = (int)((edge >> 16) & 0xffff);
+	int target = (int)(edge & 0xffff);
+	if (kind == EDGE_NORMAL_FLOW) {
+		add_dreg_normal_successor(accesses, cell, target);
+		add_dreg_normal_predecessors(accesses, target, cell);
+	}else if (kind == EDGE_JMP) {
+		add_jmp_destination(accesses, cell, target);
+	}else{
+		add_movd_destination(accesses, cell, target);
+	}
+}
+
+// records an edge found by execute. repeated edges are filtered by a small direct-mapped table of recent edges;
+// all other edges are appended to the edge log and inserted into the sets by flush_edge_log.
+void log_edge(struct AccessAnalysis* accesses, int kind, int cell, int target) {
+	unsigned long long edge = ((unsigned long long)kind << 32) | ((unsigned long long)cell << 16) | (unsigned long long)target;
+	unsigned long long* recent;
+	if (!accesses->edges.entries) {
+		if (init_edge_log(&accesses->edges)) {
+			// no memory for the log
+			apply_edge(accesses, edge);
+			return;
+		}
+		accesses->memory += EDGE_LOG_MEMORY;
+	}
+	recent = &accesses->edges.recent[(edge * 0x9E3779B97F4A7C15ULL) >> (64 - RECENT_EDGES_BITS)];
+	if (*recent == edge) {
+		return;
+	}
+	*recent = edge;
+	accesses->edges.entries[accesses->edges.length++] = edge;
+	if (accesses->edges.length == EDGE_LOG_CAPACITY) {
+		flush_edge_log(accesses);
+	}
+}
+
+// sorts the edge log by radix sort, removes duplicates and inserts the edges into the sets of the AccessAnalysis.
+void flush_edge_log(struct AccessAnalysis* accesses) {
+	struct EdgeLog* edges = &accesses->edges;
+	unsigned long long* entries = edges->entries;
+	unsigned long long* scratch = edges->scratch;
+	size_t i;
+	int shift;
+	if (!entries || edges->length == 0) {
+		return;
+	}
+	// edges have 34 bits: sort by 5 digits of 8 bits, least significant digit first
+	for (shift=0;shift<40;shift+=8) {
+		size_t count[256];
+		size_t position = 0;
+		unsigned long long* tmp;
+		memset(count, 0, sizeof(count));
+		for (i=0;i<edges->length;i++) {
+			count[(entries[i] >> shift) & 0xff]++;
+		}
+		if (count[(entries[0] >> shift) & 0xff] == edges->length) {
+			// all edges have the same digit
+			continue;
+		}
+		for (i=0;i<256;i++) {
+			size_t n = count[i];
+			count[i] = position;
+			position += n;
+		}
+		for (i=0;i<edges->length;i++) {
+			scratch[count[(entries[i] >> shift) & 0xff]++] = entries[i];
+		}
+		tmp = entries;
+		entries = scratch;
+		scratch = tmp;
+	}
+	edges->entries = entries;
+	edges->scratch = scratch;
+	for (i=0;i<edges->length;i++) {
+		if (i == 0 || entries[i] != entries[i-1]) {
+			apply_edge(accesses, entries[i]);
+		}
+	}
+	edges->length = 0;
+}
+
+// stores the cells of a connected block as an array in circular order: ascending, but if the block wraps around
+// from 59048 to 0, the run ending at 59048 comes first. the cells are freed.
+int set_circular_cell_order(struct ConnectedMemoryCells* block, struct avl_table* cells) {
+	struct avl_traverser it;
+	int* cell = 0;
+	int* ordered = 0;
+	int n = (int)cells->avl_count;
+	int start = 0;
+	int i = 0;
+	block->cells = (int*)malloc(sizeof(int)*(n>0?n:1));
+	if (!block->cells) {
+		return 1;
+	}
+	ordered = (int*)malloc(sizeof(int)*(n>0?n:1));
+	if (!ordered) {
+		free(block->cells);
+		block->cells = 0;
+		return 1;
+	}
+	avl_t_init(&it, cells);
+	while ((cell = (int*)avl_t_next(&it))) {
+		ordered[i++] = *cell;
+	}
+	if (n > 0 && ordered[0] == 0 && ordered[n-1] == 59048) {
+		start = n-1;
+		while (start > 0 && ordered[start-1] == ordered[start]-1) {
+			start--;
+		}
+	}
+	for (i=0;i<n;i++) {
+		block->cells[i] = ordered[(start+i)%n];
+	}
+	block->number_of_cells = n;
+	free(ordered);
+	avl_destroy(cells, free_integer);
+	return 0;
+}
+
+// frees a zero-terminated list of blocks returned by extract_codeblocks
+void free_codeblocks(struct ConnectedMemoryCells* components) {
+	int i;
+	if (!components) {
+		return;
+	}
+	for (i=0;components[i].cells;i++) {
+		free(components[i].cells);
+	}
+	free(components);
+}
+
+// converts the edge sets of the AccessAnalysis into compressed sparse rows.
+// the passes after the analysis read the graph from here instead of walking the AVL trees.
+int freeze_flow_graph(struct FlowGraph* graph, struct AccessAnalysis* accesses) {
+	int kind, cell;
+	memset(graph, 0, sizeof(struct FlowGraph));
+	flush_edge_log(accesses);
+	for (kind=0;kind<FLOW_GRAPH_KINDS;kind++) {
+		struct EdgeList* edges = &graph->edges[kind];
+		int number_of_edges = 0;
+		edges->offsets = (int*)malloc(sizeof(int)*(59049+1));
+		if (!edges->offsets) {
+			free_flow_graph(graph);
+			return 1;
+		}
+		for (cell=0;cell<59049;cell++) {
+			struct avl_table* set = flow_graph_set(accesses, cell, kind);
+			edges->offsets[cell] = number_of_edges;
+			if (set) {
+				number_of_edges += (int)set->avl_count;
+			}
+		}
+		edges->offsets[59049] = number_of_edges;
+		edges->targets = (int*)malloc(sizeof(int)*(number_of_edges>0?number_of_edges:1));
+		if (!edges->targets) {
+			free_flow_graph(graph);
+			return 1;
+		}
+		for (cell=0;cell<59049;cell++) {
+			struct avl_table* set = flow_graph_set(accesses, cell, kind);
+			struct avl_traverser it;
+			int* target = 0;
+			int i = edges->offsets[cell];
+			if (!set) {
+				continue;
+			}
+			avl_t_init(&it, set);
+			while ((target = (int*)avl_t_next(&it))) {
+				edges->targets[i++] = *target;
+			}
+		}
+	}
+	return 0;
+}
+
+struct avl_table* flow_graph_set(const struct AccessAnalysis* accesses, int cell, int kind) {
+	const struct MemoryCellInfo* sets = find_cell_edge_sets(accesses, cell);
+	if (!sets) {
+		return 0;
+	}
+	return *edge_set_of_kind((struct MemoryCellInfo*)sets, kind);
+}
+
+void free_flow_graph(struct FlowGraph* graph) {
+	int kind;
+	for (kind=0;kind<FLOW_GRAPH_KINDS;kind++) {
+		if (graph->edges[kind].offsets) {
+			free(graph->edges[kind].offsets);
+		}
+		if (graph->edges[kind].targets) {
+			free(graph->edges[kind].targets);
+		}
+	}
+	memset(graph, 0, sizeof(struct FlowGraph));
+}
+
+// writes one edge per line: kind, cell and target. predecessors are omitted; they are the reversed successors.
+int export_flow_graph(const struct FlowGraph* graph, const char* filename) {
+	static const char* kind_names[FLOW_GRAPH_KINDS] = {"flow", "", "jmp", "movd"};
+	FILE* file = fopen(filename, "w");
+	int kind, cell, i;
+	if (!file) {
+		return 1;
+	}
+	fprintf(file,"# kind cell target\n");
+	for (kind=0;kind<FLOW_GRAPH_KINDS;kind++) {
+		const struct EdgeList* edges = &graph->edges[kind];
+		if (kind == FLOW_PREDECESSORS) {
+			continue;
+		}
+		for (cell=0;cell<59049;cell++) {
+			for (i=edges->offsets[cell];i<edges->offsets[cell+1];i++) {
+				fprintf(file,"%s %d %d\n",kind_names[kind],cell,edges->targets[i]);
+			}
+		}
+	}
+	if (fclose(file) != 0) {
+		return 1;
+	}
+	return 0;
+}
+
+// marks cell as modified during execution. the successors of all destinations the cell has been used for by JMP or MOVD
+// must keep their offset then.
+void set_dreg_rw_access(struct AccessAnalysis* accesses, int cell) {
+	const struct MemoryCellInfo* sets = 0;
+	struct avl_traverser it;
+	int* dest = 0;
+	if (accesses->access[cell] & DREG_ACCESS_RW) {
+		return;
+	}
+	accesses->access[cell] |= DREG_ACCESS_RW;
+	accesses->coverage++;
+	sets = find_cell_edge_sets(accesses, cell);
+	if (!sets) {
+		return;
+	}
+	if (sets->dreg_movd_destinations) {
+		avl_t_init(&it, sets->dreg_movd_destinations);
+		while ((dest = (int*)avl_t_next(&it))) {
+			accesses->access[(*dest+1)%59049] |= FIXED_OFFSET;
+		}
+	}
+	if (sets->dreg_jmp_destinations) {
+		avl_t_init(&it, sets->dreg_jmp_destinations);
+		while ((dest = (int*)avl_t_next(&it))) {
+			accesses->access[(*dest+1)%59049] |= FIXED_OFFSET;
+		}
+	}
+}
+
+// the first OUT or OPR behind the entry point reads the A register; IN, ROT and HLT before make it irrelevant.
+void decide_a_register(struct AccessAnalysis* accesses, int matters) {
+	if (accesses->a_register_decided) {
+		return;
+	}
+	accesses->a_register_matters = matters;
+	accesses->a_register_decided = 1;
+}
+
+long long execute(struct VMState* state, int interactive, struct UserInput* input, struct BreakCondition break_on, long long* last_jmp, int* interrupted, struct AccessAnalysis* accesses, int access_analysis_ro, struct EventTrace* events) {
+	long long steps = execute_commands(state, interactive, input, break_on, last_jmp, interrupted, accesses, access_analysis_ro, events, 0);
+	if (events) {
+		events->steps += steps;
+	}
+	return steps;
+}
+
+// continuation may be set to continue an analysis run that has been stopped before.
+long long execute_commands(struct VMState* state, int interactive, struct UserInput* input, struct BreakCondition break_on, long long* last_jmp, int* interrupted, struct AccessAnalysis* accesses, int access_analysis_ro, struct EventTrace* events,
+		struct ExecutionContinuation* continuation) {
+	struct ExecutionContext context;
+	if (state == 0) {
+		if (last_jmp)
+			*last_jmp = 0;
+		if (interrupted)
+			*interrupted = 0;
+		return 0;
+	}
+	init_execution_context(&context, state, interactive, input, break_on, last_jmp, interrupted, accesses, access_analysis_ro, events, continuation);
+	while (execute_step(&context));
+	charge_budget(context.steps - context.charged_steps, 0);
+	if (accesses && !access_analysis_ro) {
+		flush_edge_log(accesses);
+	}
+	return context.steps;
+}
+
+void init_execution_context(struct ExecutionContext* context, struct VMState* state, int interactive, struct UserInput* input, struct BreakCondition break_on,
+		long long* last_jmp, int* interrupted, struct AccessAnalysis* accesses, int access_analysis_ro, struct EventTrace* events,
+		struct ExecutionContinuation* continuation) {
+	context->state = state;
+	context->interactive = interactive;
+	context->input = input;
+	context->output = (interactive && current_disassembler) ? current_disassembler->terminal_output : 0;
+	context->break_on = break_on;
+	context->breakpoints = (break_on.on_c || break_on.on_read || break_on.on_write || break_on.on_register);
+	context->last_jmp = last_jmp;
+	context->interrupted = interrupted;
+	context->accesses = accesses;
+	context->access_analysis_ro = access_analysis_ro;
+	context->events = events;
+	context->steps = 0;
+	context->input_pos = 0;
+	context->first_d_pos = -1;
+	context->last_accessed_d_pos = (continuation ? &continuation->last_accessed_d_pos : &context->first_d_pos);
+	context->continued = (continuation && continuation->steps > 0);
+	context->continuation = continuation;
+	context->first_executed = ((accesses && !access_analysis_ro) ? accesses->first_executed : 0);
+
+	if (last_jmp)
+		*last_jmp = 0;
+	if (interrupted)
+		*interrupted = 0;
+
+	if (interactive && input) {
+		memset(input, 0, sizeof(struct UserInput));
+	}
+
+	if (!context->continued) {
+		got_sigint();
+	}
+
+	context->c_mod94 = state->c%94;
+	context->last_coverage = (accesses ? accesses->coverage : 0);
+	context->last_coverage_step = 0;
+	context->coverage_changed = 0;
+	context->last_coverage_time = 0;
+	context->charged_steps = 0;
+	context->paused = 0;
+}
+
+// checks SIGINT, the ResourceBudget and the Checkpoint; returns 1 if the run has to be stopped
+int poll_execution(struct ExecutionContext* context) {
+	const struct AccessAnalysis* accesses = (context->access_analysis_ro ? 0 : context->accesses);
+	long long steps = context->steps - context->charged_steps;
+	context->charged_steps = context->steps;
+	if (got_sigint()) {
+		if (context->interrupted)
+			*context->interrupted = 1;
+		context->paused = 1;
+		return 1;
+	}
+	if (charge_budget(steps, accesses) || checkpoint_due()) {
+		context->paused = 1;
+		return 1;
+	}
+	return 0;
+}
+
+// checks the CoverageLimits of the analysis; returns 1 if the run has to be stopped
+int coverage_limit_reached(struct ExecutionContext* context) {
+	struct AccessAnalysis* accesses = context->accesses;
+	if (!accesses->limits.window_steps && !accesses->limits.window_seconds && !accesses->deadline) {
+		return 0;
+	}
+	if (accesses->coverage != context->last_coverage) {
+		context->last_coverage = accesses->coverage;
+		context->last_coverage_step = context->steps;
+		context->coverage_changed = 1;
+	}else if (accesses->limits.window_steps > 0 && context->steps - context->last_coverage_step >= accesses->limits.window_steps) {
+		// new edges are counted when the edge log is flushed
+		flush_edge_log(accesses);
+		if (accesses->coverage != context->last_coverage) {
+			context->last_coverage = accesses->coverage;
+			context->last_coverage_step = context->steps;
+			context->coverage_changed = 1;
+		}else{
+			accesses->coverage_truncated |= COVERAGE_SATURATED;
+			return 1;
+		}
+	}
+	if ((accesses->limits.window_seconds > 0 || accesses->deadline) && (context->steps & (COVERAGE_POLL_STEPS-1)) == 0) {
+		time_t now = time(0);
+		if (context->coverage_changed || !context->last_coverage_time) {
+			context->last_coverage_time = now;
+			context->coverage_changed = 0;
+		}
+		if (accesses->limits.window_seconds > 0 && now - context->last_coverage_time >= accesses->limits.window_seconds) {
+			flush_edge_log(accesses);
+			if (accesses->coverage == context->last_coverage) {
+				accesses->coverage_truncated |= COVERAGE_SATURATED;
+				return 1;
+			}
+			context->last_coverage = accesses->coverage;
+			context->last_coverage_step = context->steps;
+			context->last_coverage_time = now;
+		}
+		if (accesses->deadline && now >= accesses->deadline) {
+			accesses->coverage_truncated |= DEADLINE_REACHED;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+// executes a single command. returns 0 if the execution stops before or with this command.
+int execute_step(struct ExecutionContext* context) {
+	struct VMState* state = context->state;
+	int interactive = context->interactive;
+	struct UserInput* input = context->input;
+	struct BreakCondition break_on = context->break_on;
+	long long* last_jmp = context->last_jmp;
+	int* interrupted = context->interrupted;
+	struct AccessAnalysis* accesses = context->accesses;
+	int access_analysis_ro = context->access_analysis_ro;
+	struct EventTrace* events = context->events;
+	int* last_accessed_d_pos = context->last_accessed_d_pos;
+	int continued = context->continued;
+	unsigned int instruction = 0;
+
+	if (!(context->steps & (BUDGET_POLL_STEPS-1)) && poll_execution(context)) {
+		return 0;
+	}
+	if (break_on.maximal_steps > 0 && context->steps >= break_on.maximal_steps) {
+		return 0;
+	}
+	if (accesses && !access_analysis_ro && (accesses->error || coverage_limit_reached(context))) {
+		return 0;
+	}
+	if (break_on.on_cseg_outside_analysis > 0 && accesses) {
+		if (!(accesses->access[state->c] & CREG_EXECUTED)) {
+			return 0;
+		}
+	}
+	instruction = state->memory[state->c];
+	if (instruction < 33 || instruction > 126) {
+		if (interactive && current_disassembler) {
+			report_progress(current_disassembler, "Invalid command 0x%05x at 0x%05x.\n",instruction,state->c);
+		}
+		// TODO: maybe only give warning message and continue...?
+		return 0;
+	}
+	instruction = instruction_table[instruction-33][context->c_mod94];
+	if (context->breakpoints && reaches_breakpoint(&context->break_on, state, instruction)) {
+		return 0;
+	}
+	if (accesses && (context->steps || continued) && !access_analysis_ro) { // don't add very first JMP-command at entry-point here...
+		add_access_flag(accesses, state->c, CREG_EXECUTED);
+		if (context->first_executed) {
+			// several runs start at the entry point
+			long long step = accesses->start_step + (context->continuation ? context->continuation->steps : 0) + context->steps;
+			if (context->first_executed[state->c] < 0 || step < context->first_executed[state->c]) {
+				context->first_executed[state->c] = step;
+			}
+		}
+	}
+
+	switch (instruction){
+		case 4:
+			// JMP
+			if (break_on.command_mask & MALBOLGE_JMP) {
+				return 0;
+			}
+			if (events) {
+				record_event(events, EVENT_JMP, events->steps+context->steps, state->memory[state->d]);
+			}
+
+			if (accesses && !access_analysis_ro) {
+				add_access_flag(accesses, state->d, DREG_ACCESS_JUMP);
+				log_edge(accesses, EDGE_JMP, state->d, state->memory[state->d]);
+				add_access_flag(accesses, (state->memory[state->d]+1)%59049, CREG_REACHED_BY_JMP);
+
+				if (*last_accessed_d_pos != -1) {
+					log_edge(accesses, EDGE_NORMAL_FLOW, *last_accessed_d_pos, state->d);
+				}
+				*last_accessed_d_pos = state->d;
+			}
+
+			state->c = state->memory[state->d];
+			if (last_jmp)
+				*last_jmp = context->steps;
+			break;
+		case 5:
+			// OUT
+			if (break_on.command_mask & MALBOLGE_OUT) {
+				return 0;
+			}
+			if (events) {
+				record_event(events, EVENT_OUT, events->steps+context->steps, state->a);
+			}
+			if (accesses && !access_analysis_ro) {
+				decide_a_register(accesses, 1);
+			}
+			if (context->output) {
+				write_output(context->output, (unsigned char)state->a);
+			}
+			break;
+		case 23:
+			// IN
+			if (break_on.command_mask & MALBOLGE_IN) {
+				return 0;
+			}
+			if (accesses && !access_analysis_ro) {
+				decide_a_register(accesses, 0);
+			}
+			if (interactive) {
+				int read;
+				if (context->output) {
+					flush_output(context->output);
+				}
+				read = getchar();
+				if (read == EOF) {
+					if (feof(stdin)) {
+						state->a = 59048;
+						if (input) {
+							input->eof = 1;
+						}
+					} else {
+						// error or interrupt occured while reading stdin
+						// printf("ERROR");
+						got_sigint(); // maybe failed due to SIGINT, so reset SIGINT
+						if (interrupted)
+							*interrupted = 1;
+						return 0;
+					}
+				} else {
+					state->a = read;
+				}
+				// store input; characters after EOF cannot be replayed
+				if (input && read != EOF && !input->eof) {
+					append_user_input(input, (unsigned char)read);
+				}
+			}else{
+				// read from input
+				if (input) {
+					if (input->length > context->input_pos) {
+						state->a = input->input[context->input_pos];
+						context->input_pos++;
+					} else if (input->eof) {
+						state->a = 59048;
+					} else {
+						// error or interrupt occured while reading stdin
+						// printf("ERROR");
+						return 0;
+					}
+				} else {
+					// error or interrupt occured while reading stdin
+					// printf("ERROR");
+					return 0;
+				}
+			}
+			if (events) {
+				record_event(events, EVENT_IN, events->steps+context->steps, state->a);
+			}
+			break;
+		case 39:
+			// ROT
+			if (break_on.command_mask & MALBOLGE_ROT) {
+				return 0;
+			}
+
+			if (break_on.on_cseg_outside_analysis > 0 && accesses) {
+				if ((accesses->access[state->d] & CREG_EXECUTED) && !(accesses->access[state->d] & DREG_ACCESS_RW)) {
+					return 0;
+				}
+			}
+
+			if (accesses && !access_analysis_ro) {
+				set_dreg_rw_access(accesses, state->d);
+				decide_a_register(accesses, 0);
+
+				if (*last_accessed_d_pos != -1) {
+					log_edge(accesses, EDGE_NORMAL_FLOW, *last_accessed_d_pos, state->d);
+				}
+				*last_accessed_d_pos = state->d;
+			}
+			if (events) {
+				record_event(events, EVENT_ROT, events->steps+context->steps, 0);
+			}
+
+			state->a = (state->memory[state->d] = rotate_r(state->memory[state->d]));
+			break;
+		case 40:
+			// MOV
+			if (break_on.command_mask & MALBOLGE_MOV) {
+				return 0;
+			}
+			if (events) {
+				record_event(events, EVENT_MOVD, events->steps+context->steps, state->memory[state->d]);
+			}
+
+			if (accesses && !access_analysis_ro) {
+				add_access_flag(accesses, state->d, DREG_ACCESS_MOVD);
+				log_edge(accesses, EDGE_MOVD, state->d, state->memory[state->d]);
+				add_access_flag(accesses, (state->memory[state->d]+1)%59049, DREG_REACHED_BY_MOVD);
+				if (*last_accessed_d_pos != -1) {
+					log_edge(accesses, EDGE_NORMAL_FLOW, *last_accessed_d_pos, state->d);
+				}
+				*last_accessed_d_pos = (state->memory[state->d]+1)%59049; //movd -> use movd-destination as origin...
+			}
+
+			state->d = state->memory[state->d];
+			break;
+		case 62:
+			// OPR
+			if (break_on.command_mask & MALBOLGE_OPR) {
+				return 0;
+			}
+
+			if (break_on.on_cseg_outside_analysis > 0 && accesses) {
+				if ((accesses->access[state->d] & CREG_EXECUTED) && !(accesses->access[state->d] & DREG_ACCESS_RW)) {
+					return 0;
+				}
+			}
+
+			if (accesses && !access_analysis_ro) {
+				set_dreg_rw_access(accesses, state->d);
+				decide_a_register(accesses, 1);
+
+				if (*last_accessed_d_pos != -1) {
+					log_edge(accesses, EDGE_NORMAL_FLOW, *last_accessed_d_pos, state->d);
+				}
+				*last_accessed_d_pos = state->d;
+			}
+			if (events) {
+				record_event(events, EVENT_OPR, events->steps+context->steps, 0);
+			}
+
+			state->a = (state->memory[state->d] = crazy(state->a, state->memory[state->d]));
+			break;
+		case 81:
+			// HLT
+			if (break_on.command_mask & MALBOLGE_HLT) {
+				return 0;
+			}
+			if (events) {
+				record_event(events, EVENT_HLT, events->steps+context->steps, 0);
+			}
+			if (accesses && !access_analysis_ro) {
+				decide_a_register(accesses, 0);
+			}
+			context->steps++;
+			return 0;
+		case 68:
+		default:
+			// NOP
+			if (break_on.command_mask & MALBOLGE_NOP) {
+				return 0;
+			}
+			break;
+	}
+	// encrypt command
+	state->memory[state->c] = encrypt_command(state->memory[state->c]);
+
+	if (accesses && !access_analysis_ro) {
+		add_access_flag(accesses, state->c, CREG_TRANSLATED);
+	}
+
+	state->c = (state->c+1)%59049;
+	if (instruction == 4 || state->c == 0) {
+		// jumped or wrapped around 59048 -> 0
+		context->c_mod94 = state->c%94;
+	}else if (++context->c_mod94 == 94) {
+		context->c_mod94 = 0;
+	}
+
+	if (accesses && !access_analysis_ro) {
+		add_access_flag(accesses, state->c, CREG_REACHED_WO_JMP);
+	}
+
+	state->d = (state->d+1)%59049;
+	context->steps++;
+	return 1;
+}
+
+
+// returns 1 if the command instruction at c reaches one of the breakpoints of break_on
+int reaches_breakpoint(const struct BreakCondition* break_on, const struct VMState* state, int instruction) {
+	if (break_on->on_register) {
+		int value = (break_on->on_register == MD_REGISTER_A ? state->a : (break_on->on_register == MD_REGISTER_C ? state->c : state->d));
+		if (value != break_on->register_value) {
+			return 0;
+		}
+		if (!break_on->on_c && !break_on->on_read && !break_on->on_write) {
+			return 1;
+		}
+	}
+	if (break_on->on_c && BREAKPOINT_SET(break_on->on_c, state->c)) {
+		return 1;
+	}
+	if (break_on->on_read && (instruction == 4 || instruction == 39 || instruction == 40 || instruction == 62) &&
+			BREAKPOINT_SET(break_on->on_read, state->d)) {
+		return 1;
+	}
+	if (break_on->on_write && (instruction == 39 || instruction == 62) && BREAKPOINT_SET(break_on->on_write, state->d)) {
+		return 1;
+	}
+	return 0;
+}
+
+int encrypt_command(int value) {
+	// if memory[c] has been modified by the command, bring it back into valid range
+	// note that the original interpreter would crash in this case
+	// TODO: maybe give warning message if memory[c] lies outside valid range
+	if (value < 33)
+		value += 94;
+	value-=33;
+	if (value > 93)
+		value %= 94;
+	return translation[value];
+}
+
+
+struct TraceCache* create_trace_cache(int use_jit) {
+	struct TraceCache* cache = (struct TraceCache*)malloc(sizeof(struct TraceCache));
+	if (!cache) {
+		return 0;
+	}
+	memset(cache, 0, sizeof(struct TraceCache));
+	cache->use_jit = use_jit;
+	return cache;
+}
+
+void clear_trace_cache(struct TraceCache* cache) {
+	int i;
+	for (i=0;i<TRACE_CACHE_BUCKETS;i++) {
+		struct Trace* trace = cache->buckets[i];
+		while (trace) {
+			struct Trace* next = trace->next;
+			free(trace); // arrays are part of the same allocation
+			trace = next;
+		}
+		cache->buckets[i] = 0;
+	}
+	cache->number_of_traces = 0;
+	cache->jit_used = 0; // compiled code of the removed traces will be overwritten
+}
+
+void free_trace_cache(struct TraceCache* cache) {
+	if (!cache) {
+		return;
+	}
+	clear_trace_cache(cache);
+#ifdef JIT_X86_64
+	if (cache->jit_code) {
+		munmap(cache->jit_code, JIT_CODE_SIZE);
+	}
+#endif
+	free(cache);
+}
+
+struct Trace* find_trace(struct TraceCache* cache, const struct VMState* state) {
+	struct Trace* trace = cache->buckets[state->c % TRACE_CACHE_BUCKETS];
+	while (trace) {
+		if (trace->c == state->c && memcmp(trace->code, state->memory+state->c, sizeof(int)*trace->length) == 0) {
+			return trace;
+		}
+		trace = trace->next;
+	}
+	return 0;
+}
+
+struct Trace* record_trace(struct TraceCache* cache, const struct VMState* state) {
+	unsigned char commands[TRACE_MAX_LENGTH];
+	struct Trace* trace = 0;
+	int length = 0;
+	int has_data_writes = 0;
+	int c_mod94 = state->c%94;
+	int i;
+
+	// decode until the first command that does not continue straight-line
+	while (length < TRACE_MAX_LENGTH && state->c+length < 59049) {
+		int instruction = state->memory[state->c+length];
+		if (instruction < 33 || instruction > 126) {
+			break;
+		}
+		instruction = instruction_table[instruction-33][c_mod94];
+		if (instruction == 39 || instruction == 62) {
+			has_data_writes = 1;
+		}else if (is_nop(instruction)) {
+			instruction = 68;
+		}else{
+			break;
+		}
+		commands[length] = instruction;
+		length++;
+		if (++c_mod94 == 94) {
+			c_mod94 = 0;
+		}
+	}
+	if (length == 0) {
+		return 0;
+	}
+
+	if (cache->number_of_traces >= TRACE_CACHE_MAX_TRACES) {
+		clear_trace_cache(cache);
+	}
+	trace = (struct Trace*)malloc(sizeof(struct Trace) + length*(2*sizeof(int)+sizeof(unsigned char)));
+	if (!trace) {
+		return 0;
+	}
+	trace->c = state->c;
+	trace->length = length;
+	trace->has_data_writes = has_data_writes;
+	trace->hits = 0;
+	trace->compile_failed = 0;
+	trace->native = 0;
+	trace->code = (int*)(trace+1);
+	trace->encrypted = trace->code + length;
+	trace->commands = (unsigned char*)(trace->encrypted + length);
+	memcpy(trace->code, state->memory+state->c, sizeof(int)*length);
+	for (i=0;i<length;i++) {
+		trace->encrypted[i] = translation[trace->code[i]-33];
+	}
+	memcpy(trace->commands, commands, length);
+	trace->next = cache->buckets[state->c % TRACE_CACHE_BUCKETS];
+	cache->buckets[state->c % TRACE_CACHE_BUCKETS] = trace;
+	cache->number_of_traces++;
+	return trace;
+}
+
+#ifdef JIT_X86_64
+void emit_bytes(struct TraceCache* cache, const unsigned char* bytes, int length) {
+	memcpy(cache->jit_code + cache->jit_used, bytes, length);
+	cache->jit_used += length;
+}
+
+void emit_int32(struct TraceCache* cache, int value) {
+	memcpy(cache->jit_code + cache->jit_used, &value, sizeof(int));
+	cache->jit_used += sizeof(int);
+}
+
+// offset of memory[cell] relative to the VMState pointer held in rbx
+int memory_offset(int cell) {
+	return (int)(offsetof(struct VMState, memory) + sizeof(int)*cell);
+}
+#endif
+
+// compiles the trace into a native function void(struct VMState*) that has the same effect as the trace's replay.
+// the caller has to check the guards (memory contents, no data write into a later command of the trace, d != c).
+// returns 0 if the trace could not be compiled.
+int compile_trace(struct TraceCache* cache, struct Trace* trace) {
+#ifdef JIT_X86_64
+	// rbx: VMState*, r12d: d, r13d: a
+	// the code below relies on the layout of VMState: a at offset 0, c at 4, d at 8, memory at 12
+	static const unsigned char prologue[] = {
+		0x53,                         // push rbx
+		0x41, 0x54,                   // push r12
+		0x41, 0x55,                   // push r13 (stack is 16-byte aligned now)
+		0x48, 0x89, 0xFB,             // mov rbx, rdi
+		0x44, 0x8B, 0x63, 0x08,       // mov r12d, [rbx+8]  (d)
+		0x44, 0x8B, 0x2B              // mov r13d, [rbx]    (a)
+	};
+	static const unsigned char rot[] = {
+		0x42, 0x8B, 0x44, 0xA3, 0x0C, // mov eax, [rbx+r12*4+12]  (memory[d])
+		0x31, 0xD2,                   // xor edx, edx
+		0xB9, 0x03, 0x00, 0x00, 0x00, // mov ecx, 3
+		0xF7, 0xF1,                   // div ecx
+		0x69, 0xD2, 0xE3, 0x4C, 0x00, 0x00, // imul edx, edx, 19683
+		0x01, 0xD0,                   // add eax, edx
+		0x42, 0x89, 0x44, 0xA3, 0x0C, // mov [rbx+r12*4+12], eax
+		0x41, 0x89, 0xC5              // mov r13d, eax
+	};
+	static const unsigned char opr_args[] = {
+		0x44, 0x89, 0xEF,             // mov edi, r13d
+		0x42, 0x8B, 0x74, 0xA3, 0x0C, // mov esi, [rbx+r12*4+12]
+		0x48, 0xB8                    // mov rax, imm64
+	};
+	static const unsigned char opr_call[] = {
+		0xFF, 0xD0,                   // call rax
+		0x42, 0x89, 0x44, 0xA3, 0x0C, // mov [rbx+r12*4+12], eax
+		0x41, 0x89, 0xC5              // mov r13d, eax
+	};
+	static const unsigned char next_d[] = {
+		0x41, 0x83, 0xC4, 0x01,       // add r12d, 1
+		0x41, 0x81, 0xFC, 0xA9, 0xE6, 0x00, 0x00, // cmp r12d, 59049
+		0xB8, 0x00, 0x00, 0x00, 0x00, // mov eax, 0
+		0x44, 0x0F, 0x44, 0xE0        // cmove r12d, eax
+	};
+	static const unsigned char epilogue[] = {
+		0x44, 0x89, 0x63, 0x08,       // mov [rbx+8], r12d
+		0x44, 0x89, 0x2B,             // mov [rbx], r13d
+		0xC7, 0x43, 0x04              // mov dword [rbx+4], imm32  (c)
+	};
+	static const unsigned char ret[] = {
+		0x41, 0x5D,                   // pop r13
+		0x41, 0x5C,                   // pop r12
+		0x5B,                         // pop rbx
+		0xC3                          // ret
+	};
+	static const unsigned char store_command[] = {
+		0xC7, 0x83                    // mov dword [rbx+disp32], imm32
+	};
+	unsigned int (*crazy_function)(unsigned int, unsigned int) = crazy;
+	size_t size = sizeof(prologue) + sizeof(epilogue) + sizeof(int) + sizeof(ret);
+	unsigned char* start = 0;
+	int i;
+
+	// exact size of the code emitted below
+	for (i=0;i<trace->length;i++) {
+		switch (trace->commands[i]) {
+			case 39:
+				size += sizeof(rot);
+				break;
+			case 62:
+				size += sizeof(opr_args) + sizeof(void*) + sizeof(opr_call);
+				break;
+			default:
+				break;
+		}
+		size += sizeof(store_command) + 2*sizeof(int) + sizeof(next_d);
+	}
+
+	if (!cache->jit_code) {
+		cache->jit_code = (unsigned char*)mmap(0, JIT_CODE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (cache->jit_code == MAP_FAILED) {
+			cache->jit_code = 0;
+			cache->use_jit = 0;
+			return 0;
+		}
+		cache->jit_used = 0;
+	}
+	// JIT_CODE_SIZE is a multiple of 16, so the alignment of the next function stays within the mapping
+	if (cache->jit_used + size > JIT_CODE_SIZE) {
+		return 0;
+	}
+	if (mprotect(cache->jit_code, JIT_CODE_SIZE, PROT_READ | PROT_WRITE) != 0) {
+		cache->use_jit = 0;
+		return 0;
+	}
+	start = cache->jit_code + cache->jit_used;
+	emit_bytes(cache, prologue, sizeof(prologue));
+	for (i=0;i<trace->length;i++) {
+		switch (trace->commands[i]) {
+			case 39:
+				// ROT
+				emit_bytes(cache, rot, sizeof(rot));
+				break;
+			case 62:
+				// OPR
+				emit_bytes(cache, opr_args, sizeof(opr_args));
+				emit_bytes(cache, (const unsigned char*)&crazy_function, sizeof(void*));
+				emit_bytes(cache, opr_call, sizeof(opr_call));
+				break;
+			default:
+				break;
+		}
+		// encrypt command
+		emit_bytes(cache, store_command, sizeof(store_command));
+		emit_int32(cache, memory_offset(trace->c+i));
+		emit_int32(cache, trace->encrypted[i]);
+		emit_bytes(cache, next_d, sizeof(next_d));
+	}
+	emit_bytes(cache, epilogue, sizeof(epilogue));
+	emit_int32(cache, (trace->c+trace->length)%59049);
+	emit_bytes(cache, ret, sizeof(ret));
+	// align next function
+	cache->jit_used = (cache->jit_used + 15) & ~(size_t)15;
+	if (mprotect(cache->jit_code, JIT_CODE_SIZE, PROT_READ | PROT_EXEC) != 0) {
+		cache->use_jit = 0;
+		return 0;
+	}
+	trace->native = (void (*)(struct VMState*))(void*)start;
+	return 1;
+#else
+	return 0;
+#endif
+}
+
+
+long long execute_traced(struct TraceCache* cache, struct VMState* state, int interactive, struct BreakCondition break_on, long long* last_jmp, int* interrupted, struct EventTrace* events) {
+
+	long long steps = 0;
+	int was_interrupted = 0;
+
+	if (last_jmp)
+		*last_jmp = 0;
+	if (interrupted)
+		*interrupted = 0;
+	if (state == 0)
+		return 0;
+
+	if (!cache || (break_on.command_mask & (MALBOLGE_NOP | MALBOLGE_ROT | MALBOLGE_OPR)) || break_on.on_c || break_on.on_read ||
+			break_on.on_write || break_on.on_register) {
+		// traces cannot break in between
+		return execute(state, interactive, 0, break_on, last_jmp, interrupted, 0, 0, events);
+	}
+
+	got_sigint();
+
+	while (1) {
+		struct Trace* trace = 0;
+		struct BreakCondition single_step = break_on;
+		long long remaining = TRACE_MAX_LENGTH;
+		int fallback_steps = 1;
+
+		if (got_sigint()) {
+			if (interrupted)
+				*interrupted = 1;
+			return steps;
+		}
+		if (out_of_budget()) {
+			return steps;
+		}
+		if (break_on.maximal_steps > 0) {
+			if (steps >= break_on.maximal_steps) {
+				return steps;
+			}
+			remaining = break_on.maximal_steps - steps;
+		}
+
+		trace = find_trace(cache, state);
+		if (!trace) {
+			trace = record_trace(cache, state);
+		}
+		if (trace) {
+			// ROT/OPR may overwrite a command of this trace before it is executed (d-c is constant within the trace)
+			int distance = (state->d - state->c + 59049) % 59049;
+			if (trace->length <= remaining && !(trace->has_data_writes && distance > 0 && distance < trace->length)) {
+				int i;
+				int c = state->c;
+				int d = state->d;
+				int self_modifying = (trace->has_data_writes && distance == 0);
+				if (trace->hits < JIT_HOT_THRESHOLD) {
+					trace->hits++;
+				}
+				if (!self_modifying && !trace->native && !trace->compile_failed && cache->use_jit && trace->hits >= JIT_HOT_THRESHOLD) {
+					trace->compile_failed = !compile_trace(cache, trace);
+				}
+				if (!self_modifying && trace->native && !(events && trace->has_data_writes)) {
+					trace->native(state);
+					steps += trace->length;
+					charge_budget(trace->length, 0);
+					if (events) {
+						events->steps += trace->length;
+					}
+					continue;
+				}
+				for (i=0;i<trace->length;i++) {
+					switch (trace->commands[i]) {
+						case 39:
+							// ROT
+							if (events) {
+								record_event(events, EVENT_ROT, events->steps+i, 0);
+							}
+							state->a = (state->memory[d] = rotate_r(state->memory[d]));
+							break;
+						case 62:
+							// OPR
+							if (events) {
+								record_event(events, EVENT_OPR, events->steps+i, 0);
+							}
+							state->a = (state->memory[d] = crazy(state->a, state->memory[d]));
+							break;
+						default:
+							break;
+					}
+					if (self_modifying && trace->commands[i] != 68) {
+						state->memory[c] = encrypt_command(state->memory[c]);
+					}else{
+						state->memory[c] = trace->encrypted[i];
+					}
+					c++;
+					d = (d == 59048 ? 0 : d+1);
+				}
+				state->c = c % 59049;
+				state->d = d;
+				steps += trace->length;
+				charge_budget(trace->length, 0);
+				if (events) {
+					events->steps += trace->length;
+				}
+				continue;
+			}
+			fallback_steps = trace->length;
+		}
+
+		// JMP, MOVD, IN, OUT, HLT, invalid command, self-modifying trace or step limit reached:
+		// fall back to the reference implementation, one step at a time.
+		single_step.maximal_steps = 1;
+		if (fallback_steps > remaining) {
+			fallback_steps = remaining;
+		}
+		while (fallback_steps > 0) {
+			int instruction = state->memory[state->c];
+			long long executed = 0;
+			if (instruction >= 33 && instruction <= 126) {
+				instruction = instruction_table[instruction-33][state->c%94];
+			}
+			executed = execute(state, interactive, 0, single_step, 0, &was_interrupted, 0, 0, events);
+			if (was_interrupted) {
+				if (interrupted)
+					*interrupted = 1;
+				return steps + executed;
+			}
+			if (executed == 0 || instruction == 81) {
+				// break condition, HLT, invalid command or missing input
+				return steps + executed;
+			}
+			if (instruction == 4 && last_jmp) {
+				*last_jmp = steps;
+			}
+			steps += executed;
+			fallback_steps--;
+		}
+	}
+}
+
+// executes up to steps steps of the engine's run, reading input from input (may be 0) after the characters read so far.
+// execute_traced stops at IN commands; they are executed by execute, one character at a time.
+// returns the number of steps executed, fewer than steps if the program has halted, waits for more input, has reached
+// an invalid command or has been interrupted.
+long long run_lockstep_engine(struct LockstepEngine* engine, const struct UserInput* input, long long steps, int* interrupted) {
+	struct BreakCondition break_on = {0, 0, 0};
+	struct UserInput remaining;
+	long long executed = 0;
+
+	*interrupted = 0;
+	engine->steps = 0;
+	if (steps <= 0) {
+		return 0;
+	}
+	memset(&remaining, 0, sizeof(struct UserInput));
+	if (!engine->cache) {
+		struct ExecutionContext context;
+		if (input) {
+			remaining.input = input->input ? input->input + engine->input_pos : 0;
+			remaining.length = input->length - engine->input_pos;
+			remaining.eof = input->eof;
+		}
+		break_on.maximal_steps = steps;
+		init_execution_context(&context, engine->state, 0, input ? &remaining : 0, break_on, 0, interrupted, 0, 0, 0, 0);
+		while (execute_step(&context));
+		engine->input_pos += context.input_pos;
+		engine->steps = context.steps;
+		return context.steps;
+	}
+	while (executed < steps) {
+		long long in_steps;
+		break_on.maximal_steps = steps - executed;
+		executed += execute_traced(engine->cache, engine->state, 0, break_on, 0, interrupted, 0);
+		if (executed >= steps || *interrupted || !waits_for_input(engine->state) || !input ||
+				(engine->input_pos >= input->length && !input->eof)) {
+			break;
+		}
+		remaining.input = input->input ? input->input + engine->input_pos : 0;
+		remaining.length = (engine->input_pos < input->length ? 1 : 0);
+		remaining.eof = input->eof;
+		break_on.maximal_steps = 1;
+		in_steps = execute(engine->state, 0, &remaining, break_on, 0, interrupted, 0, 0, 0);
+		if (in_steps == 0) {
+			break;
+		}
+		engine->input_pos += remaining.length;
+		executed += in_steps;
+	}
+	engine->steps = executed;
+	return executed;
+}
+
+// returns 1 if engine has ended its last call of run_lockstep_engine in another state than reference
+int lockstep_diverged(const struct LockstepEngine* reference, const struct LockstepEngine* engine) {
+	const struct VMState* expected = reference->state;
+	const struct VMState* actual = engine->state;
+	return engine->steps != reference->steps || engine->input_pos != reference->input_pos || actual->a != expected->a ||
+			actual->c != expected->c || actual->d != expected->d || memcmp(actual->memory, expected->memory, sizeof(int)*59049) != 0;
+}
+
+// both engines have agreed on agreed_state after start_step steps and input_pos characters of input, but not steps
+// steps later. the first step that differs is found by bisection; every probe runs both engines from agreed_state
+// again. reports the differences of the registers and the memory after this step.
+int locate_divergence(struct Disassembler* disassembler, struct LockstepEngine* reference, struct LockstepEngine* engine,
+		const struct VMState* agreed_state, size_t input_pos, const struct UserInput* input, long long start_step, long long steps) {
+	const struct VMState* expected = reference->state;
+	const struct VMState* actual = engine->state;
+	long long agreed = 0;
+	long long differs = steps;
+	int interrupted = 0;
+	int instruction, c, d;
+	int differences = 0;
+	int i;
+
+	while (differs - agreed > 1 && !interrupted) {
+		long long middle = agreed + (differs - agreed)/2;
+		int engine_interrupted = 0;
+		copy_state(reference->state, agreed_state);
+		copy_state(engine->state, agreed_state);
+		reference->input_pos = engine->input_pos = input_pos;
+		run_lockstep_engine(reference, input, middle, &interrupted);
+		run_lockstep_engine(engine, input, middle, &engine_interrupted);
+		interrupted |= engine_interrupted;
+		if (lockstep_diverged(reference, engine)) {
+			differs = middle;
+		}else{
+			agreed = middle;
+		}
+	}
+	if (interrupted) {
+		return report_error(disassembler, MD_ERROR_DIVERGENCE, "The %s differs from the reference implementation between step %lld and %lld.",
+				engine->name, start_step+agreed+1, start_step+differs);
+	}
+
+	// the reference implementation executes the last step on its own to show the command
+	copy_state(reference->state, agreed_state);
+	copy_state(engine->state, agreed_state);
+	reference->input_pos = engine->input_pos = input_pos;
+	run_lockstep_engine(reference, input, agreed, &interrupted);
+	c = expected->c;
+	d = expected->d;
+	instruction = expected->memory[c];
+	run_lockstep_engine(reference, input, 1, &interrupted);
+	reference->steps = differs;
+	run_lockstep_engine(engine, input, differs, &interrupted);
+
+	report_progress(disassembler, "The %s differs from the reference implementation at step %lld, command %s at 0x%05x, d = 0x%05x:\n",
+			engine->name, start_step+differs, (instruction >= 33 && instruction <= 126) ? instruction_names[instruction_table[instruction-33][c%94]] :
+			"(invalid)", c, d);
+	if (engine->steps != reference->steps) {
+		report_progress(disassembler, "  steps executed:  %lld instead of %lld\n", engine->steps, reference->steps);
+	}
+	if (actual->a != expected->a) {
+		report_progress(disassembler, "  a:               0x%05x instead of 0x%05x\n", actual->a, expected->a);
+	}
+	if (actual->c != expected->c) {
+		report_progress(disassembler, "  c:               0x%05x instead of 0x%05x\n", actual->c, expected->c);
+	}
+	if (actual->d != expected->d) {
+		report_progress(disassembler, "  d:               0x%05x instead of 0x%05x\n", actual->d, expected->d);
+	}
+	if (engine->input_pos != reference->input_pos) {
+		report_progress(disassembler, "  characters read: %lu instead of %lu\n", (unsigned long)engine->input_pos, (unsigned long)reference->input_pos);
+	}
+	for (i=0;i<59049;i++) {
+		if (actual->memory[i] != expected->memory[i]) {
+			if (differences < LOCKSTEP_DIFF_CELLS) {
+				report_progress(disassembler, "  memory[0x%05x]: 0x%05x instead of 0x%05x\n", i, actual->memory[i], expected->memory[i]);
+			}
+			differences++;
+		}
+	}
+	if (differences > LOCKSTEP_DIFF_CELLS) {
+		report_progress(disassembler, "  ... and %d other memory cells\n", differences - LOCKSTEP_DIFF_CELLS);
+	}
+	if (!lockstep_diverged(reference, engine)) {
+		// e.g. a trace has been compiled by the probes in the meantime
+		report_progress(disassembler, "  no difference in the last probe; the result of the engine depends on its cache\n");
+	}
+	return report_error(disassembler, MD_ERROR_DIVERGENCE, "The %s differs from the reference implementation at step %lld.",
+			engine->name, start_step+differs);
+}
+
+
+void init_event_trace(struct EventTrace* events, FILE* file) {
+	memset(events, 0, sizeof(struct EventTrace));
+	events->file = file;
+}
+
+void free_event_trace(struct EventTrace* events) {
+	if (!events) {
+		return;
+	}
+	if (events->buffer) {
+		free(events->buffer);
+	}
+	events->buffer = 0;
+	events->length = 0;
+	events->capacity = 0;
+}
+
+void put_event_byte(struct EventTrace* events, unsigned char byte) {
+	if (events->file) {
+		if (putc(byte, events->file) == EOF) {
+			events->failed = 1;
+		}
+		events->length++;
+		return;
+	}
+	if (events->length == events->capacity) {
+		size_t capacity = events->capacity ? 2*events->capacity : 4096;
+		unsigned char* tmp = (unsigned char*)realloc(events->buffer, capacity);
+		if (!tmp) {
+			events->failed = 1;
+			return;
+		}
+		events->buffer = tmp;
+		events->capacity = capacity;
+	}
+	events->buffer[events->length++] = byte;
+}
+
+void put_event_varint(struct EventTrace* events, unsigned long long value) {
+	while (value >= 0x80) {
+		put_event_byte(events, (unsigned char)(value & 0x7f) | 0x80);
+		value >>= 7;
+	}
+	put_event_byte(events, (unsigned char)value);
+}
+
+void put_event_header(struct EventTrace* events, int kind, long long step) {
+	long long delta = step - events->last_event_step;
+	events->last_event_step = step;
+	if (delta < EVENT_STEP_DELTA_VARINT) {
+		put_event_byte(events, kind | (int)(delta << 4));
+	}else{
+		put_event_byte(events, kind | (EVENT_STEP_DELTA_VARINT << 4));
+		put_event_varint(events, delta);
+	}
+}
+
+void begin_event_trace_run(struct EventTrace* events, const struct VMState* state) {
+	if (!events || !state) {
+		return;
+	}
+	events->steps = 0;
+	events->last_event_step = 0;
+	put_event_header(events, EVENT_BEGIN, 0);
+	put_event_varint(events, state->a);
+	put_event_varint(events, state->c);
+	put_event_varint(events, state->d);
+}
+
+void end_event_trace_run(struct EventTrace* events) {
+	if (!events) {
+		return;
+	}
+	put_event_header(events, EVENT_END, events->steps);
+	if (events->file && fflush(events->file) != 0) {
+		events->failed = 1;
+	}
+}
+
+void record_event(struct EventTrace* events, int kind, long long step, int value) {
+	put_event_header(events, kind, step);
+	if (kind == EVENT_JMP || kind == EVENT_MOVD || kind == EVENT_OUT || kind == EVENT_IN) {
+		put_event_varint(events, value);
+	}
+}
+
+
+int open_event_trace_buffer(struct EventTraceReader* reader, const struct EventTrace* events) {
+	memset(reader, 0, sizeof(struct EventTraceReader));
+	if (!events || events->failed || events->file) {
+		return 1;
+	}
+	reader->data = events->buffer;
+	reader->length = events->length;
+	return 0;
+}
+
+int open_event_trace_file(struct EventTraceReader* reader, FILE* file) {
+	long length = 0;
+	memset(reader, 0, sizeof(struct EventTraceReader));
+	if (!file || fflush(file) != 0 || fseek(file, 0, SEEK_END) != 0) {
+		return 1;
+	}
+	length = ftell(file);
+	if (length <= 0) {
+		return 1;
+	}
+#ifndef WINDOWS
+	// map the trace instead of reading it; it may be much larger than the available memory
+	reader->mapping = mmap(0, length, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (reader->mapping == MAP_FAILED) {
+		reader->mapping = 0;
+		return 1;
+	}
+	reader->mapping_length = length;
+	reader->data = (const unsigned char*)reader->mapping;
+#else
+	reader->mapping = malloc(length);
+	if (!reader->mapping) {
+		return 1;
+	}
+	if (fseek(file, 0, SEEK_SET) != 0 || fread(reader->mapping, 1, length, file) != (size_t)length) {
+		free(reader->mapping);
+		reader->mapping = 0;
+		return 1;
+	}
+	reader->mapping_length = length;
+	reader->data = (const unsigned char*)reader->mapping;
+#endif
+	reader->length = length;
+	return 0;
+}
+
+void close_event_trace_reader(struct EventTraceReader* reader) {
+	if (reader->mapping) {
+#ifndef WINDOWS
+		munmap(reader->mapping, reader->mapping_length);
+#else
+		free(reader->mapping);
+#endif
+	}
+	memset(reader, 0, sizeof(struct EventTraceReader));
+}
+
+int get_event_varint(struct EventTraceReader* reader, unsigned long long* value) {
+	int shift = 0;
+	*value = 0;
+	while (reader->position < reader->length && shift < 64) {
+		unsigned char byte = reader->data[reader->position++];
+		*value |= (unsigned long long)(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			return 0;
+		}
+		shift += 7;
+	}
+	return 1;
+}
+
+// returns 0 if no further event is available.
+// event->c and event->d are the registers at event->step, i.e. before the command has been executed
+int read_event(struct EventTraceReader* reader, struct ExecutionEvent* event) {
+	unsigned long long value = 0;
+	long long delta = 0;
+	if (reader->position >= reader->length) {
+		return 0;
+	}
+	event->kind = reader->data[reader->position] & 0x0f;
+	delta = reader->data[reader->position] >> 4;
+	reader->position++;
+	if (delta == EVENT_STEP_DELTA_VARINT) {
+		if (get_event_varint(reader, &value)) {
+			return 0;
+		}
+		delta = (long long)value;
+	}
+	event->value = 0;
+	if (event->kind == EVENT_BEGIN) {
+		unsigned long long a = 0, c = 0, d = 0;
+		if (get_event_varint(reader, &a) || get_event_varint(reader, &c) || get_event_varint(reader, &d)) {
+			return 0;
+		}
+		reader->step = 0;
+		reader->sync_step = 0;
+		reader->sync_c = (int)c;
+		reader->sync_d = (int)d;
+		event->value = (int)a;
+	}else{
+		reader->step += delta;
+		if (event->kind == EVENT_JMP || event->kind == EVENT_MOVD || event->kind == EVENT_OUT || event->kind == EVENT_IN) {
+			if (get_event_varint(reader, &value)) {
+				return 0;
+			}
+			event->value = (int)value;
+		}
+	}
+	event->step = reader->step;
+	event->c = (int)((reader->sync_c + (reader->step - reader->sync_step)) % 59049);
+	event->d = (int)((reader->sync_d + (reader->step - reader->sync_step)) % 59049);
+	if (event->kind == EVENT_JMP) {
+		reader->sync_step = event->step + 1;
+		reader->sync_c = (event->value + 1) % 59049;
+		reader->sync_d = (event->d + 1) % 59049;
+	}else if (event->kind == EVENT_MOVD) {
+		reader->sync_step = event->step + 1;
+		reader->sync_c = (event->c + 1) % 59049;
+		reader->sync_d = (event->value + 1) % 59049;
+	}
+	return 1;
+}
+
+
+// computes the optimized entry point like the replay in optimize_entrypoint does, but reads the recorded run
+// from the initial state instead of executing the Malbolge program again.
+// returns -1 if the recorded run does not reach the entry point.
+long long find_optimized_entrypoint_in_trace(struct EventTraceReader* reader, long long steps_to_entrypoint, const struct AccessAnalysis* accesses) {
+	struct ExecutionEvent event;
+	long long optimized_entry_steps = 0;
+	int searching_jmp = 0; // a command outside the access analysis has been executed, wait for next JMP
+	long long step = 0;
+	if (!read_event(reader, &event) || event.kind != EVENT_BEGIN) {
+		return -1;
+	}
+	while (read_event(reader, &event)) {
+		long long last_step = (event.kind == EVENT_END ? event.step - 1 : event.step);
+		// commands between two events are executed in a straight line
+		int c = (int)(((event.c - (event.step - step)) % 59049 + 59049) % 59049);
+		for (;step <= last_step;step++) {
+			if (step >= steps_to_entrypoint) {
+				return searching_jmp ? steps_to_entrypoint : optimized_entry_steps;
+			}
+			if (!searching_jmp) {
+				if (!(accesses->access[c] & CREG_EXECUTED)) {
+					searching_jmp = 1;
+				}else if (step == event.step && (event.kind == EVENT_ROT || event.kind == EVENT_OPR) &&
+						(accesses->access[event.d] & CREG_EXECUTED) && !(accesses->access[event.d] & DREG_ACCESS_RW)) {
+					searching_jmp = 1;
+				}
+			}
+			if (searching_jmp && step == event.step && event.kind == EVENT_JMP) {
+				// new entry point candidate; continue with the command at the jump destination
+				optimized_entry_steps = step;
+				searching_jmp = 0;
+			}
+			c = (c == 59048 ? 0 : c+1);
+		}
+		if (event.kind == EVENT_END) {
+			if (step >= steps_to_entrypoint) {
+				return searching_jmp ? steps_to_entrypoint : optimized_entry_steps;
+			}
+			break;
+		}
+	}
+	return -1;
+}
+
+
+// appends a node to the trie. returns -1 if out of memory.
+int add_transcript_node(struct TranscriptTrie* trie, unsigned char* input, size_t length, int eof) {
+	int node;
+	if (trie->number_of_nodes == trie->capacity) {
+		struct TranscriptNode* tmp = (struct TranscriptNode*)realloc(trie->nodes, sizeof(struct TranscriptNode)*2*trie->capacity);
+		if (!tmp) {
+			return -1;
+		}
+		trie->nodes = tmp;
+		trie->capacity *= 2;
+	}
+	node = trie->number_of_nodes++;
+	trie->nodes[node].input = input;
+	trie->nodes[node].length = length;
+	trie->nodes[node].eof = eof;
+	trie->nodes[node].terminal = 0;
+	trie->nodes[node].first_child = -1;
+	trie->nodes[node].next_sibling = -1;
+	return node;
+}
+
+// returns the child of node whose input starts with the first character of input, or the EOF child if eof is set.
+// creates a child with the whole input if there is none. returns -1 if out of memory.
+int get_transcript_child(struct TranscriptTrie* trie, int node, unsigned char* input, size_t length, int eof) {
+	int child = trie->nodes[node].first_child;
+	int last = -1;
+	while (child != -1) {
+		if (eof ? trie->nodes[child].eof : (!trie->nodes[child].eof && trie->nodes[child].input[0] == input[0])) {
+			return child;
+		}
+		last = child;
+		child = trie->nodes[child].next_sibling;
+	}
+	child = add_transcript_node(trie, eof ? 0 : input, eof ? 0 : length, eof);
+	if (child == -1) {
+		return -1;
+	}
+	// keep the order of the transcripts
+	if (last == -1) {
+		trie->nodes[node].first_child = child;
+	}else{
+		trie->nodes[last].next_sibling = child;
+	}
+	return child;
+}
+
+// adds a transcript to the trie. a node whose input differs from the transcript is split where they diverge.
+// returns the node that ends the transcript or -1 if out of memory.
+int add_transcript(struct TranscriptTrie* trie, const struct UserInput* transcript) {
+	int node = 0;
+	size_t position = 0;
+	while (position < transcript->length) {
+		size_t common = 0;
+		int child = get_transcript_child(trie, node, transcript->input+position, transcript->length-position, 0);
+		if (child == -1) {
+			return -1;
+		}
+		while (common < trie->nodes[child].length && position+common < transcript->length &&
+				trie->nodes[child].input[common] == transcript->input[position+common]) {
+			common++;
+		}
+		if (common < trie->nodes[child].length) {
+			// the rest of the node's input becomes its only child
+			int rest = add_transcript_node(trie, trie->nodes[child].input+common, trie->nodes[child].length-common, 0);
+			if (rest == -1) {
+				return -1;
+			}
+			trie->nodes[rest].terminal = trie->nodes[child].terminal;
+			trie->nodes[rest].first_child = trie->nodes[child].first_child;
+			trie->nodes[child].length = common;
+			trie->nodes[child].terminal = 0;
+			trie->nodes[child].first_child = rest;
+		}
+		node = child;
+		position += common;
+	}
+	if (transcript->eof) {
+		node = get_transcript_child(trie, node, 0, 0, 1);
+		if (node == -1) {
+			return -1;
+		}
+	}
+	trie->nodes[node].terminal = 1;
+	return node;
+}
+
+// builds a trie of the inputs of the given files (zero-terminated list). the files are mapped while the trie is used.
+int build_transcript_trie(struct Disassembler* disassembler, struct TranscriptTrie* trie, char** user_input_files) {
+	int number_of_files = 0;
+	int i;
+	memset(trie, 0, sizeof(struct TranscriptTrie));
+	while (user_input_files[number_of_files]) {
+		number_of_files++;
+	}
+	trie->files = (struct TranscriptFile*)calloc(number_of_files+1, sizeof(struct TranscriptFile));
+	trie->capacity = 1024;
+	trie->nodes = (struct TranscriptNode*)malloc(sizeof(struct TranscriptNode)*trie->capacity);
+	if (!trie->files || !trie->nodes) {
+		free_transcript_trie(trie);
+		return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+	// root: no input
+	add_transcript_node(trie, 0, 0, 0);
+	for (i=0;i<number_of_files;i++) {
+		int result = open_transcript_file(&trie->files[i], user_input_files[i]);
+		if (result) {
+			free_transcript_trie(trie);
+			return report_error(disassembler, MD_ERROR_FILE, result == 1 ? "Cannot open input file %s." :
+					"Input file %s has been saved by another version of the disassembler.", user_input_files[i]);
+		}
+		trie->number_of_transcripts++;
+		if (trie->files[i].has_output) {
+			trie->recorded_outputs++;
+		}
+		if (add_transcript(trie, &trie->files[i].input) == -1) {
+			free_transcript_trie(trie);
+			return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+		}
+	}
+	// a split moves the end of a transcript to the new node, so the ends are looked up when the trie is complete.
+	// adding a transcript again does not change the trie.
+	for (i=0;i<number_of_files;i++) {
+		trie->files[i].node = add_transcript(trie, &trie->files[i].input);
+	}
+	return 0;
+}
+
+void free_transcript_trie(struct TranscriptTrie* trie) {
+	int i;
+	if (trie->nodes) {
+		free(trie->nodes);
+	}
+	for (i=0;i<trie->number_of_transcripts;i++) {
+		close_transcript_file(&trie->files[i]);
+	}
+	if (trie->files) {
+		free(trie->files);
+	}
+	memset(trie, 0, sizeof(struct TranscriptTrie));
+}
+
+// continues an analysis run that has been stopped by execute_commands because the input has been exhausted.
+long long continue_execution(struct VMState* state, struct UserInput* input, int* interrupted, struct AccessAnalysis* accesses,
+		struct ExecutionContinuation* continuation) {
+	struct BreakCondition break_on = {0, 0, 0};
+	long long steps = execute_commands(state, 0, input, break_on, 0, interrupted, accesses, 0, 0, continuation);
+	continuation->steps += steps;
+	if (accesses && continuation->steps > accesses->maximal_steps_from_entry_point) {
+		accesses->maximal_steps_from_entry_point = continuation->steps;
+	}
+	return steps;
+}
+
+// returns whether the Malbolge program waits for input, i.e. it has been stopped at an IN command.
+int waits_for_input(const struct VMState* state) {
+	int instruction = state->memory[state->c];
+	return instruction >= 33 && instruction <= 126 && instruction_table[instruction-33][state->c%94] == 23;
+}
+
+// returns whether the Malbolge program has halted, i.e. it has been stopped at a HLT command.
+int has_halted(const struct VMState* state) {
+	int instruction = state->memory[state->c];
+	return instruction >= 33 && instruction <= 126 && instruction_table[instruction-33][state->c%94] == 81;
+}
+
+// executes the given programs round-robin, one command each, until one of them stops.
+// the memory of the next program is prefetched while the current one is executed, so the
+// cache misses of the programs overlap. returns the index of the stopped program.
+int execute_interleaved(struct ExecutionContext** contexts, int number_of_contexts) {
+	while (1) {
+		int i;
+		for (i=0;i<number_of_contexts;i++) {
+#ifdef __GNUC__
+			const struct VMState* next = contexts[i+1 < number_of_contexts ? i+1 : 0]->state;
+			__builtin_prefetch(&next->memory[next->c]);
+			__builtin_prefetch(&next->memory[next->d], 1);
+#endif
+			if (!execute_step(contexts[i])) {
+				return i;
+			}
+		}
+	}
+}
+
+// lets the lane read the input of its node in place, after the first fed characters.
+void feed_transcript_lane(struct TranscriptTrie* trie, struct TranscriptLane* lane, size_t fed, struct AccessAnalysis* accesses) {
+	struct BreakCondition break_on = {0, 0, 0};
+	const struct TranscriptNode* node = &trie->nodes[lane->node];
+	lane->fed = fed;
+	lane->input.input = node->input ? node->input+fed : 0;
+	lane->input.length = node->length-fed;
+	lane->input.capacity = 0;
+	lane->input.eof = node->eof;
+	init_execution_context(&lane->context, lane->state, 0, &lane->input, break_on, 0, &lane->interrupted, accesses, 0, 0, &lane->continuation);
+	lane->context.output = trie->recorded_outputs ? &lane->output : 0;
+}
+
+// compares the output of a lane that has halted with the recorded output of the transcripts that end at its node.
+void verify_transcript_output(struct TranscriptTrie* trie, struct TranscriptLane* lane) {
+	int i;
+	if (!trie->recorded_outputs || !has_halted(lane->state)) {
+		return;
+	}
+	for (i=0;i<trie->number_of_transcripts;i++) {
+		struct TranscriptFile* file = &trie->files[i];
+		if (file->node == lane->node && file->has_output) {
+			file->output_verified = (file->output_hash == lane->output.hash && file->output_length == lane->output.length) ? 1 : -1;
+		}
+	}
+}
+
+// replays the input of a transcript whose recorded output has not been reproduced and shows the output of the replay.
+// the lanes only hash their output, so the run is repeated with a capture.
+void report_transcript_output(struct Disassembler* disassembler, const struct VMState* entry_state, const struct TranscriptFile* file) {
+	struct BreakCondition break_on = {0, 0, 0};
+	struct ExecutionContext context;
+	struct OutputSink output;
+	struct UserInput input = file->input;
+	char shown[TRANSCRIPT_SHOWN_OUTPUT+1];
+	size_t length;
+	size_t i;
+	VMState* state = (VMState*)malloc(sizeof(VMState));
+	if (!state) {
+		return;
+	}
+	copy_state(state,entry_state);
+	input.capacity = 0;
+	init_output_sink(&output, OUTPUT_CAPTURE);
+	init_execution_context(&context, state, 0, &input, break_on, 0, 0, 0, 0, 0, 0);
+	context.output = &output;
+	while (execute_step(&context));
+	if (has_halted(state) && !output.failed) {
+		length = output.captured.length < TRANSCRIPT_SHOWN_OUTPUT ? output.captured.length : TRANSCRIPT_SHOWN_OUTPUT;
+		for (i=0;i<length;i++) {
+			unsigned char c = output.captured.input[i];
+			shown[i] = (c == '\n' || (c >= 32 && c <= 126)) ? (char)c : '?';
+		}
+		shown[length] = 0;
+		report_progress(disassembler, "It has written %llu characters instead of %llu:\n%s%s\n",
+				output.length, file->output_length, shown, output.captured.length > length ? "..." : "");
+	}
+	free_output_sink(&output);
+	free(state);
+}
+
+// lets the lane continue with its next input. if the lane has consumed all input of its transcripts, it takes a waiting
+// branch instead. returns 1 if out of memory.
+int start_transcript_lane(struct TranscriptTrie* trie, struct TranscriptLane* lane, struct TranscriptBranch** branches,
+		int* number_of_branches, int* branches_capacity, struct AccessAnalysis* accesses) {
+	size_t fed = 0;
+	if (lane->active && (trie->nodes[lane->node].first_child == -1 || !waits_for_input(lane->state))) {
+		// all transcripts of this lane are done
+		verify_transcript_output(trie, lane);
+		free(lane->state);
+		lane->state = 0;
+		lane->active = 0;
+	}
+	if (!lane->active) {
+		if (*number_of_branches == 0) {
+			return 0;
+		}
+		(*number_of_branches)--;
+		lane->node = (*branches)[*number_of_branches].node;
+		lane->state = (*branches)[*number_of_branches].state;
+		lane->continuation = (*branches)[*number_of_branches].continuation;
+		fed = (*branches)[*number_of_branches].fed;
+		init_output_sink(&lane->output, OUTPUT_HASH);
+		lane->output.hash = (*branches)[*number_of_branches].output_hash;
+		lane->output.length = (*branches)[*number_of_branches].output_length;
+		lane->active = 1;
+	}else{
+		int child = trie->nodes[lane->node].first_child;
+		while (trie->nodes[child].next_sibling != -1) {
+			// the transcripts diverge: fork the Malbolge program
+			child = trie->nodes[child].next_sibling;
+			if (*number_of_branches == *branches_capacity) {
+				int capacity = *branches_capacity ? 2*(*branches_capacity) : 16;
+				struct TranscriptBranch* tmp = (struct TranscriptBranch*)realloc(*branches, sizeof(struct TranscriptBranch)*capacity);
+				if (!tmp) {
+					accesses->error = MD_ERROR_MEMORY;
+					return 1;
+				}
+				*branches = tmp;
+				*branches_capacity = capacity;
+			}
+			(*branches)[*number_of_branches].state = (VMState*)malloc(sizeof(VMState));
+			if (!(*branches)[*number_of_branches].state) {
+				accesses->error = MD_ERROR_MEMORY;
+				return 1;
+			}
+			copy_state((*branches)[*number_of_branches].state, lane->state);
+			(*branches)[*number_of_branches].node = child;
+			(*branches)[*number_of_branches].fed = 0;
+			(*branches)[*number_of_branches].continuation = lane->continuation;
+			(*branches)[*number_of_branches].output_hash = lane->output.hash;
+			(*branches)[*number_of_branches].output_length = lane->output.length;
+			(*number_of_branches)++;
+		}
+		lane->node = trie->nodes[lane->node].first_child;
+	}
+	feed_transcript_lane(trie, lane, fed, accesses);
+	return 0;
+}
+
+// adds the steps of the lane's current run to its continuation.
+void account_transcript_lane(struct TranscriptLane* lane, struct AccessAnalysis* accesses) {
+	charge_budget(lane->context.steps - lane->context.charged_steps, 0);
+	lane->continuation.steps += lane->context.steps;
+	if (lane->continuation.steps > accesses->maximal_steps_from_entry_point) {
+		accesses->maximal_steps_from_entry_point = lane->continuation.steps;
+	}
+	lane->context.steps = 0;
+	lane->context.charged_steps = 0;
+}
+
+// writes the active lanes and the waiting branches to the checkpoint. every lane is between two commands; its run is
+// continued by a new ExecutionContext afterwards. returns 1 if the checkpoint cannot be written.
+int save_transcript_checkpoint(struct Checkpoint* checkpoint, struct TranscriptTrie* trie, struct TranscriptLane* lanes,
+		const struct TranscriptBranch* branches, int number_of_branches, struct AccessAnalysis* accesses) {
+	struct TranscriptBranch* runs = 0;
+	int number_of_runs = 0;
+	int failed = 0;
+	int i;
+
+	runs = (struct TranscriptBranch*)malloc(sizeof(struct TranscriptBranch)*(EXECUTION_LANES+number_of_branches));
+	if (!runs) {
+		failed = 1;
+	}
+	for (i=0;i<EXECUTION_LANES;i++) {
+		struct TranscriptLane* lane = &lanes[i];
+		size_t fed;
+		if (!lane->active) {
+			continue;
+		}
+		account_transcript_lane(lane, accesses);
+		fed = lane->fed + lane->context.input_pos;
+		if (runs) {
+			runs[number_of_runs].node = lane->node;
+			runs[number_of_runs].fed = fed;
+			runs[number_of_runs].state = lane->state;
+			runs[number_of_runs].continuation = lane->continuation;
+			runs[number_of_runs].output_hash = lane->output.hash;
+			runs[number_of_runs].output_length = lane->output.length;
+			number_of_runs++;
+		}
+		feed_transcript_lane(trie, lane, fed, accesses);
+	}
+	if (runs) {
+		memcpy(runs+number_of_runs, branches, sizeof(struct TranscriptBranch)*number_of_branches);
+		number_of_runs += number_of_branches;
+		failed = write_checkpoint(checkpoint, accesses, runs, number_of_runs);
+		free(runs);
+	}
+	checkpoint->failed |= failed;
+	checkpoint->due = 0;
+	checkpoint->next = time(0) + checkpoint->interval;
+	return failed;
+}
+
+// executes the transcripts of the trie, starting with the given runs. the array of runs is freed.
+// up to EXECUTION_LANES runs are executed interleaved; the runs share the execution of common prefixes, a state is copied
+// only where transcripts diverge. if checkpoint is set, the runs are written to it periodically and when the replay stops
+// before all runs have been finished. returns 1 if the execution has been interrupted.
+int replay_transcript_trie(struct TranscriptTrie* trie, struct TranscriptBranch* runs, int number_of_runs, struct AccessAnalysis* accesses,
+		struct Checkpoint* checkpoint) {
+	struct TranscriptLane lanes[EXECUTION_LANES];
+	struct ExecutionContext* contexts[EXECUTION_LANES];
+	struct TranscriptLane* active_lanes[EXECUTION_LANES];
+	struct TranscriptBranch* branches = runs;
+	int number_of_branches = number_of_runs;
+	int branches_capacity = number_of_runs;
+	int finished = 0;
+	int failed = 0;
+	int i;
+
+	memset(lanes, 0, sizeof(lanes));
+	while (!failed) {
+		int number_of_active_lanes = 0;
+		int stopped;
+		struct TranscriptLane* lane;
+		// idle lanes take waiting branches
+		for (i=0;i<EXECUTION_LANES && !failed;i++) {
+			if (!lanes[i].active) {
+				failed = start_transcript_lane(trie, &lanes[i], &branches, &number_of_branches, &branches_capacity, accesses);
+			}
+			if (lanes[i].active) {
+				contexts[number_of_active_lanes] = &lanes[i].context;
+				active_lanes[number_of_active_lanes] = &lanes[i];
+				number_of_active_lanes++;
+			}
+		}
+		if (failed) {
+			break;
+		}
+		if (number_of_active_lanes == 0) {
+			finished = 1;
+			break;
+		}
+		stopped = execute_interleaved(contexts, number_of_active_lanes);
+		lane = active_lanes[stopped];
+		account_transcript_lane(lane, accesses);
+		if (lane->interrupted) {
+			failed = 1;
+			break;
+		}
+		if (!lane->context.paused) {
+			// the program has consumed its input or ended
+			failed = start_transcript_lane(trie, lane, &branches, &number_of_branches, &branches_capacity, accesses);
+		}
+		if (failed || (accesses->coverage_truncated & DEADLINE_REACHED) || out_of_budget()) {
+			break;
+		}
+		if (checkpoint && checkpoint->due) {
+			save_transcript_checkpoint(checkpoint, trie, lanes, branches, number_of_branches, accesses);
+		}
+	}
+	flush_edge_log(accesses);
+	if (checkpoint && !accesses->error) {
+		if (finished) {
+			remove_checkpoint(checkpoint);
+		}else{
+			save_transcript_checkpoint(checkpoint, trie, lanes, branches, number_of_branches, accesses);
+		}
+	}
+	for (i=0;i<EXECUTION_LANES;i++) {
+		if (lanes[i].state) {
+			free(lanes[i].state);
+		}
+	}
+	for (i=0;i<number_of_branches;i++) {
+		free(branches[i].state);
+	}
+	if (branches) {
+		free(branches);
+	}
+	return failed && !accesses->error;
+}
+
+// returns a run from the entry state that runs to the first IN command and follows the trie then, or 0 if out of memory.
+struct TranscriptBranch* create_root_run(const struct VMState* entry_state) {
+	struct TranscriptBranch* run = (struct TranscriptBranch*)malloc(sizeof(struct TranscriptBranch));
+	if (!run) {
+		return 0;
+	}
+	run->state = (VMState*)malloc(sizeof(VMState));
+	if (!run->state) {
+		free(run);
+		return 0;
+	}
+	copy_state(run->state,entry_state);
+	run->node = 0;
+	run->fed = 0;
+	run->continuation.steps = 0;
+	run->continuation.last_accessed_d_pos = -1;
+	run->output_hash = OUTPUT_HASH_BASIS;
+	run->output_length = 0;
+	return run;
+}
+
+// if checkpoint has loaded runs, the analysis continues them; otherwise it starts at the entry point.
+int transcript_access_analysis(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, char** user_input_files,
+		struct CoverageLimits limits, struct Checkpoint* checkpoint) {
+	struct TranscriptTrie trie;
+	struct TranscriptBranch* runs = 0;
+	int number_of_runs = 0;
+	int interrupted = 0;
+	int i;
+	struct SigintHandler handler;
+	if (!entry_state || !accesses || !user_input_files) {
+		free_checkpoint_runs(checkpoint);
+		return 1;
+	}
+	if (build_transcript_trie(disassembler, &trie, user_input_files)) {
+		free_checkpoint_runs(checkpoint);
+		return 1;
+	}
+	for (i=0;i<checkpoint->number_of_runs;i++) {
+		if (checkpoint->runs[i].node >= trie.number_of_nodes || checkpoint->runs[i].fed > trie.nodes[checkpoint->runs[i].node].length) {
+			free_checkpoint_runs(checkpoint);
+			free_transcript_trie(&trie);
+			return report_error(disassembler, MD_ERROR_FILE, "Invalid checkpoint file: %s",checkpoint->filename);
+		}
+	}
+	if (checkpoint->runs) {
+		runs = checkpoint->runs;
+		number_of_runs = checkpoint->number_of_runs;
+		checkpoint->runs = 0;
+		checkpoint->number_of_runs = 0;
+	}else{
+		runs = create_root_run(entry_state);
+		if (!runs) {
+			free_transcript_trie(&trie);
+			return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+		}
+		number_of_runs = 1;
+		reset_access_analysis(accesses);
+	}
+	report_progress(disassembler, "\nThe disassembler needs to identify the memory cells that are ever used.\n");
+	report_progress(disassembler, "Therefore the disassembler will execute the Malbolge program now with the input\nof %d input file%s.\n",
+			trie.number_of_transcripts, trie.number_of_transcripts==1?"":"s");
+	report_progress(disassembler, "You can interrupt execution of the Malbolge program and continue disassembling\nby pressing CTRL+C anytime.\n");
+
+	if (install_sigint_handler(disassembler, &handler)) {
+		for (i=0;i<number_of_runs;i++) {
+			free(runs[i].state);
+		}
+		free(runs);
+		free_transcript_trie(&trie);
+		return report_error(disassembler, MD_ERROR_SYSTEM, "Cannot set CTRL handler.");
+	}
+	set_coverage_limits(accesses, limits);
+	if (checkpoint->filename) {
+		checkpoint->next = time(0) + checkpoint->interval;
+		disassembler->checkpoint = checkpoint;
+	}
+	report_progress(disassembler, "Running Malbolge program...");
+	interrupted = replay_transcript_trie(&trie, runs, number_of_runs, accesses, checkpoint->filename ? checkpoint : 0);
+	disassembler->checkpoint = 0;
+	restore_sigint_handler(&handler);
+	if (accesses->error) {
+		free_transcript_trie(&trie);
+		return report_error(disassembler, accesses->error, "Not enough memory.");
+	}
+	report_progress(disassembler, " %s.\n",interrupted?"interrupted":(out_of_budget()?"stopped":"done"));
+	if (checkpoint->failed) {
+		report_progress(disassembler, "Warning: cannot write the checkpoint file: %s\n",checkpoint->filename);
+	}
+	if (trie.recorded_outputs) {
+		int verified = 0;
+		for (i=0;i<trie.number_of_transcripts;i++) {
+			if (trie.files[i].output_verified == 1) {
+				verified++;
+			}else if (trie.files[i].output_verified == -1) {
+				report_progress(disassembler, "Warning: the output of the Malbolge program differs from the output recorded with\ninput file %s.\n",
+						user_input_files[i]);
+				report_transcript_output(disassembler, entry_state, &trie.files[i]);
+			}
+		}
+		report_progress(disassembler, "The output recorded with %d of %d input file%s has been reproduced.\n",
+				verified, trie.recorded_outputs, trie.recorded_outputs==1?"":"s");
+	}
+	if (accesses->coverage_truncated) {
+		print_coverage_truncation(disassembler, accesses->coverage_truncated, limits);
+	}
+	// later runs must not be truncated
+	memset(&accesses->limits, 0, sizeof(struct CoverageLimits));
+	accesses->deadline = 0;
+	free_transcript_trie(&trie);
+	return 0;
+}
+
+// analyzes a single input file from the entry state; accesses is reset before. *interrupted is set if the run has been
+// interrupted.
+int replay_single_transcript(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, char* filename,
+		struct CoverageLimits limits, int* interrupted) {
+	char* files[2];
+	struct TranscriptTrie trie;
+	struct TranscriptBranch* runs;
+	files[0] = filename;
+	files[1] = 0;
+	if (build_transcript_trie(disassembler, &trie, files)) {
+		return 1;
+	}
+	runs = create_root_run(entry_state);
+	if (!runs) {
+		free_transcript_trie(&trie);
+		return report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+	reset_access_analysis(accesses);
+	set_coverage_limits(accesses, limits);
+	*interrupted = replay_transcript_trie(&trie, runs, 1, accesses, 0);
+	free_transcript_trie(&trie);
+	if (accesses->error) {
+		return report_error(disassembler, accesses->error, "Not enough memory.");
+	}
+	return 0;
+}
+
+// analyzes every input file on its own and collects the coverage features it produces. the smallest set of input files
+// that produces all features is selected greedily; their names are written to disassembler->minimize_filename.
+// selected_files receives the selected files (zero-terminated; the names are not copied) and features the union of
+// the features of all files. if the runs are interrupted or stopped by the budget, *selected_files stays 0.
+int minimize_transcripts(struct Disassembler* disassembler, struct AccessAnalysis* accesses, const struct VMState* entry_state, char** user_input_files,
+		struct CoverageLimits limits, char*** selected_files, struct CoverageFeatures* features) {
+	struct CoverageFeatures* inputs = 0;
+	struct CoverageAttribution attribution;
+	struct SigintHandler handler;
+	size_t* costs = 0;
+	size_t* gains = 0;
+	int* selected = 0;
+	int number_of_inputs = 0;
+	int number_of_selected = 0;
+	int interrupted = 0;
+	int installed = 0;
+	int result = 0;
+	int i;
+	FILE* file = 0;
+
+	*selected_files = 0;
+	memset(features, 0, sizeof(struct CoverageFeatures));
+	memset(&attribution, 0, sizeof(struct CoverageAttribution));
+	while (user_input_files[number_of_inputs]) {
+		number_of_inputs++;
+	}
+	inputs = (struct CoverageFeatures*)calloc(number_of_inputs, sizeof(struct CoverageFeatures));
+	costs = (size_t*)calloc(number_of_inputs, sizeof(size_t));
+	gains = (size_t*)calloc(number_of_inputs, sizeof(size_t));
+	selected = (int*)calloc(number_of_inputs, sizeof(int));
+	if (!inputs || !costs || !gains || !selected) {
+		result = report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+	}
+	if (!result) {
+		report_progress(disassembler, "\nThe disassembler analyzes each of the %d input files on its own to find the\nsmallest set of input files with the same analysis.\n",
+				number_of_inputs);
+		if (install_sigint_handler(disassembler, &handler)) {
+			result = report_error(disassembler, MD_ERROR_SYSTEM, "Cannot set CTRL handler.");
+		}else{
+			installed = 1;
+		}
+	}
+	for (i=0;i<number_of_inputs && !result;i++) {
+		long long steps = disassembler->steps;
+		result = replay_single_transcript(disassembler, accesses, entry_state, user_input_files[i], limits, &interrupted);
+		if (result || interrupted || out_of_budget()) {
+			break;
+		}
+		// replaying a file costs its steps
+		costs[i] = (size_t)(disassembler->steps - steps);
+		if (collect_coverage_features(accesses, &inputs[i])) {
+			result = report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+			break;
+		}
+		report_progress(disassembler, "Input file %s: %lu features.\n", user_input_files[i], (unsigned long)inputs[i].length);
+	}
+	if (installed) {
+		restore_sigint_handler(&handler);
+	}
+	if (!result && (interrupted || out_of_budget())) {
+		report_progress(disassembler, "The minimization has been %s. All input files will be analyzed.\n", interrupted?"interrupted":"stopped");
+	}else if (!result) {
+		if (build_coverage_attribution(inputs, number_of_inputs, &attribution) ||
+				(number_of_selected = minimize_coverage(&attribution, inputs, number_of_inputs, costs, selected, gains)) < 0 ||
+				!(*selected_files = (char**)malloc(sizeof(char*)*(number_of_selected+1)))) {
+			result = report_error(disassembler, MD_ERROR_MEMORY, "Not enough memory.");
+		}
+	}
+	if (*selected_files) {
+		file = fopen(disassembler->minimize_filename, "w");
+		if (!file) {
+			result = report_error(disassembler, MD_ERROR_FILE, "Cannot write to file: %s",disassembler->minimize_filename);
+		}else{
+			fprintf(file, "# %d of %d input files produce all %lu features of the analysis\n", number_of_selected, number_of_inputs,
+					(unsigned long)attribution.number_of_features);
+			for (i=0;i<number_of_selected;i++) {
+				fprintf(file, "# adds %lu features; %lu features are produced by no other input file\n%s\n", (unsigned long)gains[i],
+						(unsigned long)count_unique_features(&attribution, &inputs[selected[i]], selected[i]), user_input_files[selected[i]]);
+				(*selected_files)[i] = user_input_files[selected[i]];
+			}
+			(*selected_files)[number_of_selected] = 0;
+			if (fclose(file) != 0) {
+				result = report_error(disassembler, MD_ERROR_FILE, "Cannot write to file: %s",disassembler->minimize_filename);
+			}
+		}
+		if (result) {
+			free(*selected_files);
+			*selected_files = 0;
+		}else{
+			report_progress(disassembler, "%d of %d input files produce all %lu features. Their names have been written to\n%s.\n",
+					number_of_selected, number_of_inputs, (unsigned long)attribution.number_of_features, disassembler->minimize_filename);
+			// the union is kept to check the analysis of the selected files
+			features->features = attribution.features;
+			features->length = attribution.number_of_features;
+			attribution.features = 0;
+		}
+	}
+	free_coverage_attribution(&attribution);
+	for (i=0;inputs && i<number_of_inputs;i++) {
+		free_coverage_features(&inputs[i]);
+	}
+	if (inputs) {
+		free(inputs);
+	}
+	if (costs) {
+		free(costs);
+	}
+	if (gains) {
+		free(gains);
+	}
+	if (selected) {
+		free(selected);
+	}
+	return result;
+}
+
+void copy_state(struct VMState* dest, const struct VMState* src) {
+	if (src == 0 || dest == 0)
+		return;
+	dest->a = src->a;
+	dest->c = src->c;
+	dest->d = src->d;
+	memcpy(dest->memory, src->memory, sizeof(int)*59060);
+}
+
+#ifdef WINDOWS
+BOOL WINAPI sigint_handler(DWORD signal) {
+	struct Disassembler* disassembler = sigint_disassembler;
+	if (signal == CTRL_C_EVENT && disassembler) {
+		disassembler->interrupt = 1;
+	}
+	return TRUE;
+}
+#else
+void sigint_handler(int s) {
+	struct Disassembler* disassembler = sigint_disassembler;
+	if (disassembler) {
+		disassembler->interrupt = 1;
+	}
+}
+#endif
+
+// lets CTRL+C interrupt the analysis runs of disassembler if it has asked for it by handle_sigint.
+// returns 1 if the handler cannot be installed.
+int install_sigint_handler(struct Disassembler* disassembler, struct SigintHandler* handler) {
+	memset(handler, 0, sizeof(struct SigintHandler));
+	if (!disassembler->handle_sigint) {
+		return 0;
+	}
+	sigint_disassembler = disassembler;
+#ifndef WINDOWS
+	{
+		struct sigaction action;
+		action.sa_handler = sigint_handler;
+		sigemptyset(&action.sa_mask);
+		action.sa_flags = 0;
+		sigaction(SIGINT, &action, &handler->old_action);
+	}
+#else
+	if (!SetConsoleCtrlHandler(sigint_handler, TRUE)) {
+		sigint_disassembler = 0;
+		return 1;
+	}
+#endif
+	handler->installed = 1;
+	return 0;
+}
+
+void restore_sigint_handler(struct SigintHandler* handler) {
+	if (!handler->installed) {
+		return;
+	}
+#ifndef WINDOWS
+	sigaction(SIGINT, &handler->old_action, 0);
+#else
+	SetConsoleCtrlHandler(sigint_handler, FALSE);
+#endif
+	sigint_disassembler = 0;
+	handler->installed = 0;
+}
+
+// charges executed steps to the ResourceBudget of the disassemble call running in this thread.
+// the clock and the memory of accesses (may be 0) are checked only every BUDGET_POLL_STEPS steps; so is the time of
+// the next Checkpoint.
+// returns 1 if the budget is exhausted.
+int charge_budget(long long steps, const struct AccessAnalysis* accesses) {
+	struct Disassembler* disassembler = current_disassembler;
+	if (!disassembler) {
+		return 0;
+	}
+	disassembler->steps += steps;
+	if (!disassembler->budget_enforced) {
+		return 0;
+	}
+	if (disassembler->budget.maximal_steps > 0 && disassembler->steps >= disassembler->budget.maximal_steps) {
+		disassembler->budget_exhausted |= MD_BUDGET_STEPS;
+	}
+	disassembler->budget_countdown -= steps;
+	if (disassembler->budget_countdown <= 0) {
+		time_t now = ((disassembler->budget_deadline || disassembler->checkpoint) ? time(0) : 0);
+		disassembler->budget_countdown = BUDGET_POLL_STEPS;
+		if (disassembler->budget_deadline && now >= disassembler->budget_deadline) {
+			disassembler->budget_exhausted |= MD_BUDGET_TIME;
+		}
+		if (disassembler->checkpoint && now >= disassembler->checkpoint->next) {
+			disassembler->checkpoint->due = 1;
+		}
+	}
+	if (accesses && disassembler->budget.maximal_memory > 0 && accesses->memory > disassembler->budget.maximal_memory) {
+		disassembler->budget_exhausted |= MD_BUDGET_MEMORY;
+	}
+	return disassembler->budget_exhausted != 0;
+}
+
+// returns 1 if the ResourceBudget of the disassemble call running in this thread is exhausted
+int out_of_budget() {
+	struct Disassembler* disassembler = current_disassembler;
+	return disassembler && disassembler->budget_enforced && disassembler->budget_exhausted;
+}
+
+// returns 1 if the runs of the disassemble call running in this thread have to stop for a checkpoint
+int checkpoint_due() {
+	struct Disassembler* disassembler = current_disassembler;
+	return disassembler && disassembler->checkpoint && disassembler->checkpoint->due;
+}
+
+// returns 1 once after the analysis run of the disassemble call in this thread has been interrupted
+int got_sigint() {
+	struct Disassembler* disassembler = current_disassembler;
+	if (disassembler && disassembler->interrupt) {
+		disassembler->interrupt = 0;
+		return 1;
+	}
+	return 0;
+}
+
+void copy_access_analysis(struct AccessAnalysis* dest, struct AccessAnalysis* src) {
+	int i;
+	if (src == 0 || dest == 0) {
+		return;
+	}
+	// the pages of edge sets are shared, so copying is cheap. both copies are independent nevertheless:
+	// cell_edge_sets copies a shared page before an edge is added to it.
+	flush_edge_log(src);
+	memcpy(dest, src, sizeof(struct AccessAnalysis));
+	memset(&dest->edges, 0, sizeof(struct EdgeLog));
+	dest->first_executed = 0; // belongs to src
+	for (i=0;i<EDGE_SET_PAGES;i++) {
+		if (dest->edge_sets[i]) {
+			dest->edge_sets[i]->references++;
+		}
+	}
+}
+
+// clears access for a new analysis. the edge log is kept, so it need not be allocated again; so are first_executed,
+// which is cleared, and start_step.
+void reset_access_analysis(struct AccessAnalysis* access) {
+	struct EdgeLog edges = access->edges;
+	long long* first_executed = access->first_executed;
+	long long start_step = access->start_step;
+	int i;
+	for (i=0;i<EDGE_SET_PAGES;i++) {
+		release_edge_set_page(access->edge_sets[i]);
+	}
+	memset(access, 0, sizeof(struct AccessAnalysis));
+	access->start_step = start_step;
+	if (first_executed) {
+		for (i=0;i<59049;i++) {
+			first_executed[i] = -1;
+		}
+		access->first_executed = first_executed;
+	}
+	if (edges.entries) {
+		for (i=0;i<RECENT_EDGES;i++) {
+			edges.recent[i] = EDGE_NONE;
+		}
+		edges.length = 0;
+		access->edges = edges;
+		access->memory = EDGE_LOG_MEMORY;
+	}
+}
+
+// frees the allocations of access; not the root
+void free_access_analysis(struct AccessAnalysis* access) {
+	int i;
+	if (!access) {
+		return;
+	}
+	for (i=0;i<EDGE_SET_PAGES;i++) {
+		release_edge_set_page(access->edge_sets[i]);
+		access->edge_sets[i] = 0;
+	}
+	if (access->edges.entries) {
+		free(access->edges.entries);
+		free(access->edges.scratch);
+		free(access->edges.recent);
+	}
+	memset(&access->edges, 0, sizeof(struct EdgeLog));
+}
@@ -0,0 +1,164 @@
+/*
+
+	This file is part of the Malbolge disassembler.
+	Copyright (C) 2016 Matthias Lutter
+
+	The Malbolge disassembler is free software: you can redistribute it
+	and/or modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation, either version 3 of
+	the License, or (at your option) any later version.
+
+	The Malbolge disassembler is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+	of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	E-Mail: matthias@lutter.cc
+
+
+
+	For more Malbolge stuff, please visit
+	<https://lutter.cc/>
+
+*/
+
+
+#ifndef DISASSEMBLER_H
+#define DISASSEMBLER_H
+
+#include <signal.h>
+#include <stddef.h>
+#include <time.h>
+
+// results of disassemble
+#define MD_OK                0
+#define MD_ERROR_MEMORY      1
+#define MD_ERROR_FILE        2 // a file cannot be read or written
+#define MD_ERROR_PROGRAM     3 // the Malbolge program is invalid
+#define MD_ERROR_ENTRY_POINT 4 // no entry point has been found
+#define MD_ERROR_ARGUMENTS   5
+#define MD_ERROR_CANCELED    6 // the user has canceled the interactive analysis
+#define MD_ERROR_SYSTEM      7
+#define MD_ERROR_INTERNAL    8
+#define MD_ERROR_BUDGET      9 // the budget has been exhausted before the entry point has been found
+#define MD_ERROR_DIVERGENCE 10 // an execution engine has not reproduced the reference implementation (check_engines, check_crazy)
+
+// budgets that have been exhausted
+#define MD_BUDGET_TIME   0x0001
+#define MD_BUDGET_STEPS  0x0002
+#define MD_BUDGET_MEMORY 0x0004
+
+// early termination of analysis runs if no new access information is found anymore. a limit of 0 is off.
+typedef struct CoverageLimits {
+	int window_steps; // stop a run after this number of steps without new coverage
+	int window_seconds; // stop a run after this time without new coverage
+	int deadline_seconds; // stop all runs after this time since the begin of the analysis
+} CoverageLimits;
+
+// registers of the condition of Breakpoints
+#define MD_REGISTER_A 1
+#define MD_REGISTER_C 2
+#define MD_REGISTER_D 3
+
+#define MD_BREAKPOINT_BITMAP_SIZE ((59049+7)/8) // bytes of a bitmap with one bit for each memory cell
+
+// where run_to_breakpoint stops, before the command is executed. a cell is set in a bitmap by
+// bitmap[cell/8] |= 1 << (cell%8).
+typedef struct Breakpoints {
+	unsigned char code[MD_BREAKPOINT_BITMAP_SIZE]; // commands at these addresses
+	unsigned char reads[MD_BREAKPOINT_BITMAP_SIZE]; // JMP, MOVD, ROT and OPR reading memory[d] of these cells
+	unsigned char writes[MD_BREAKPOINT_BITMAP_SIZE]; // ROT and OPR writing memory[d] of these cells
+	int has_code, has_reads, has_writes; // the bitmap is not empty
+	int on_register; // MD_REGISTER_*: the breakpoints only stop if this register has register_value; without
+	                 // breakpoints, stop whenever it has this value. 0: no condition
+	int register_value;
+} Breakpoints;
+
+struct DisassemblerBuffers;
+struct Checkpoint;
+struct OutputSink;
+
+// resources of a whole disassemble call. a limit of 0 is off.
+// if a budget is exhausted, the analysis stops and the HeLL file is generated from the memory accesses found so far.
+typedef struct ResourceBudget {
+	int deadline_seconds; // wall clock time
+	long long maximal_steps; // Malbolge commands executed by all runs
+	size_t maximal_memory; // bytes of the access analysis
+} ResourceBudget;
+
+// receives the progress messages of the disassembler; message is only valid during the call
+typedef void (*ProgressCallback)(void* user_data, const char* message);
+
+// everything a disassemble call needs. several calls may run at the same time in different threads,
+// each with its own Disassembler.
+typedef struct Disassembler {
+	// options
+	int use_jit;
+	struct CoverageLimits limits;
+	struct ResourceBudget budget;
+	char** user_input_files; // zero-terminated list of input files; 0: ask the user on the terminal
+	const char* transcript_prefix; // save the input of every run on the terminal to <prefix>-<run>.in (optional)
+	const char* minimize_filename; // write the smallest set of user_input_files with the same analysis to this file and
+	                               // analyze only these files (optional)
+	const char* graph_filename; // write the data flow graph to this file (optional)
+	const char* debug_filename; // write the debug information of the HeLL file to this file (optional)
+	const char* checkpoint_filename; // save the analysis to this file periodically and resume it from there (optional;
+	                                 // only with user_input_files)
+	int checkpoint_seconds; // between two checkpoints; 0: every minute
+	int handle_sigint; // let CTRL+C interrupt the analysis runs; only for a single disassemble call at a time
+	ProgressCallback progress; // optional
+	void* user_data; // passed to progress
+
+	// may be set by another thread or a signal handler to interrupt the current analysis run
+	volatile sig_atomic_t interrupt;
+
+	// result
+	int error; // MD_OK or MD_ERROR_*
+	char error_message[256];
+	int budget_exhausted; // MD_BUDGET_* of the budgets that have been exhausted; the HeLL file is partial then
+	long long steps; // Malbolge commands executed
+
+	// budget of the running call
+	time_t budget_deadline;
+	long long budget_countdown; // steps until the clock and the memory are checked again
+	int budget_enforced; // the runs after the analysis are bounded anyway; they are not stopped
+	struct Checkpoint* checkpoint; // of the running transcript analysis or 0
+	struct OutputSink* terminal_output; // output of the runs on the terminal, buffered
+
+	// allocated by the first disassemble call and reused by the following ones
+	struct DisassemblerBuffers* buffers;
+} Disassembler;
+
+// sets all options to their defaults
+void init_disassembler(struct Disassembler* disassembler);
+
+// frees the buffers kept by disassemble; the Disassembler may be used again afterwards
+void free_disassembler(struct Disassembler* disassembler);
+
+// disassembles malbolge_file into the HeLL file output_filename.
+// returns MD_OK or one of MD_ERROR_*; disassembler->error_message describes the error then.
+int disassemble(struct Disassembler* disassembler, const char* malbolge_file, const char* output_filename);
+
+// runs malbolge_file with the reference implementation and with the trace cache (and its JIT if use_jit) side by side
+// and compares the registers, the input read so far and the memory every interval steps. there is one run for each of
+// the user_input_files, or a single run without input. a run ends when the program halts, waits for more input or has
+// executed budget.maximal_steps steps. the other options are ignored.
+// returns MD_OK if all engines are bit-exact, MD_ERROR_DIVERGENCE if one is not (error_message names the first step
+// that differs), or one of MD_ERROR_*.
+int check_engines(struct Disassembler* disassembler, const char* malbolge_file, long long interval);
+
+// compares the crazy operation with the original digit by digit loop for all 59049^2 pairs of 10-trit operands and for
+// operands above 10 trits. the options are ignored.
+// returns MD_OK if they agree, MD_ERROR_DIVERGENCE if they do not (error_message names the operands).
+int check_crazy(struct Disassembler* disassembler);
+
+// runs malbolge_file from its start, with the input of the first of the user_input_files or with input and output on
+// the terminal, until it reaches one of the breakpoints, halts, waits for more input or has executed
+// budget.maximal_steps steps. the state of the program is described by progress messages then.
+// returns MD_OK or one of MD_ERROR_*.
+int run_to_breakpoint(struct Disassembler* disassembler, const char* malbolge_file, const struct Breakpoints* breakpoints);
+
+#endif
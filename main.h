@@ -28,10 +28,22 @@
 #ifndef MAIN_H
 #define MAIN_H
 
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+#define WINDOWS
+#endif
+
+#include <stdio.h>
+#include <time.h>
+#ifndef WINDOWS
+#include <pthread.h>
+#endif
+
 #include "avl-2.0.2a/avl.h"
+#include "disassembler.h"
 
 #define HELL_FILE_EXTENSION "hell"
 #define MALBOLGE_DEBUG_FILE_EXTENSION "dbg"
+#define TRANSCRIPT_FILE_EXTENSION "in"
 
 typedef struct VMState {
 	int a,c,d;
@@ -39,23 +51,21 @@ typedef struct VMState {
 } VMState;
 
 
-const int DREG_ACCESS_MOVD     = 0x0001; // value might be replaced by destination label (if no RW access at all)
-const int DREG_ACCESS_JUMP     = 0x0002; // value might be replaced by destination label (if no RW access at all)
-const int DREG_ACCESS_RW       = 0x0004;
-const int DREG_REACHED_BY_MOVD = 0x0008; // label required
+static const int DREG_ACCESS_MOVD     = 0x0001; // value might be replaced by destination label (if no RW access at all)
+static const int DREG_ACCESS_JUMP     = 0x0002; // value might be replaced by destination label (if no RW access at all)
+static const int DREG_ACCESS_RW       = 0x0004;
+static const int DREG_REACHED_BY_MOVD = 0x0008; // label required
 
-const int CREG_EXECUTED        = 0x0100; // shall be in CSEG, if not already in DSEG
-const int CREG_TRANSLATED      = 0x0200; // that means, we have a direct successor; and it means that the cycle may be important
-const int CREG_REACHED_BY_JMP  = 0x0400; // label may be required (or not, if it is just a NOP-Chain, but this is more advanced analysis)
-const int CREG_REACHED_WO_JMP  = 0x0800; // that means, we have a direct predecessor
+static const int CREG_EXECUTED        = 0x0100; // shall be in CSEG, if not already in DSEG
+static const int CREG_TRANSLATED      = 0x0200; // that means, we have a direct successor; and it means that the cycle may be important
+static const int CREG_REACHED_BY_JMP  = 0x0400; // label may be required (or not, if it is just a NOP-Chain, but this is more advanced analysis)
+static const int CREG_REACHED_WO_JMP  = 0x0800; // that means, we have a direct predecessor
 
-const int FIXED_OFFSET         = 0x8000; // must be at a fixed position
+static const int FIXED_OFFSET         = 0x8000; // must be at a fixed position
 
 
+// edge sets of a memory cell. they are rarely used, so they are kept apart from the access flags.
 typedef struct MemoryCellInfo {
-//	int value; // initial value on entry point
-	int access; // flags: DREG_ACCESS_MOVD, DREG_ACCESS_JUMP, DREG_ACCESS_RW, DREG_REACHED_BY_MOVD; CREG_EXECUTED, CREG_TRANSLATED, CREG_REACHED_BY_JMP
-
 	// first successing dreg-cell with interaction, if no movd is performed. movd-successors can be found below.
 	struct avl_table* dreg_successors_normal_flow; // use it to build reachability-graph
 	struct avl_table* dreg_predecessors_normal_flow; // use it to build reachability-graph
@@ -66,58 +76,624 @@ typedef struct MemoryCellInfo {
 
 } MemoryCellInfo;
 
+// the edge sets are stored in pages of cells. copies of an AccessAnalysis share their pages until one of them
+// adds an edge to a page.
+#define EDGE_SET_PAGE_CELLS 243
+#define EDGE_SET_PAGES (59049/EDGE_SET_PAGE_CELLS)
+
+typedef struct EdgeSetPage {
+	int references; // number of AccessAnalysis using this page
+	struct MemoryCellInfo cells[EDGE_SET_PAGE_CELLS];
+} EdgeSetPage;
+
+
+static const int COVERAGE_SATURATED = 0x0001;
+static const int DEADLINE_REACHED   = 0x0002;
+
+// the clock is read only every COVERAGE_POLL_STEPS steps (power of 2)
+#define COVERAGE_POLL_STEPS 65536
+
+// SIGINT and the ResourceBudget are checked every BUDGET_POLL_STEPS steps of a run (power of 2);
+// the clock and the memory only every BUDGET_POLL_STEPS steps of all runs.
+#define BUDGET_POLL_STEPS 4096
+
+// edges found by execute: kind << 32 | cell << 16 | target
+#define EDGE_LOG_CAPACITY (1024*1024)
+#define RECENT_EDGES_BITS 12
+#define RECENT_EDGES (1 << RECENT_EDGES_BITS)
+#define EDGE_NONE (~0ULL)
+
+static const int EDGE_NORMAL_FLOW = 0; // target is the next data cell accessed after cell
+static const int EDGE_JMP         = 1; // cell is used as jump destination target
+static const int EDGE_MOVD        = 2; // cell is used as movd destination target
+
+#define EDGE_MEMORY (sizeof(struct avl_node) + sizeof(int)) // of an edge in the sets
+#define EDGE_LOG_MEMORY (sizeof(unsigned long long)*(2*EDGE_LOG_CAPACITY + RECENT_EDGES))
+
+typedef struct EdgeLog {
+	unsigned long long* entries; // not yet inserted into the sets; may contain duplicates
+	unsigned long long* scratch; // for sorting
+	size_t length;
+	unsigned long long* recent; // direct-mapped filter of edges logged recently
+} EdgeLog;
 
 typedef struct AccessAnalysis {
 //	int a,c,d;
 //	int n_jump_destinations;
 //	int* jump_destinations;
 	int a_register_matters;
-	int maximal_steps_from_entry_point;
-	struct MemoryCellInfo memory[59049];
+	int a_register_decided; // first OUT, OPR, IN, ROT or HLT behind the entry point has been executed
+	long long maximal_steps_from_entry_point;
+	unsigned int coverage; // number of flags and edges found so far
+	struct CoverageLimits limits;
+	time_t deadline;
+	int coverage_truncated; // COVERAGE_SATURATED, DEADLINE_REACHED if a run has been stopped by the limits
+	int error; // MD_ERROR_MEMORY if an edge or a run could not be stored; the analysis runs stop then
+	size_t memory; // bytes allocated for the edges, estimated
+	struct EdgeLog edges; // call flush_edge_log before the edge sets are read
+	struct EdgeSetPage* edge_sets[EDGE_SET_PAGES]; // allocated when the first edge of a page is added
+	long long* first_executed; // optional, not owned: step since the begin of the program at which each cell has been
+	                           // executed first, -1 if never; the steps before the entry point are not recorded
+	long long start_step; // steps from the begin of the program to the entry point of the runs
+	// flags of each memory cell: DREG_ACCESS_MOVD, DREG_ACCESS_JUMP, DREG_ACCESS_RW, DREG_REACHED_BY_MOVD;
+	// CREG_EXECUTED, CREG_TRANSLATED, CREG_REACHED_BY_JMP, CREG_REACHED_WO_JMP; FIXED_OFFSET
+	unsigned short access[59049];
 } AccessAnalysis;
 
+// edge sets of the AccessAnalysis as compressed sparse rows: the targets of cell are targets[offsets[cell]..offsets[cell+1]-1]
+typedef struct EdgeList {
+	int* offsets; // 59049+1 entries
+	int* targets; // sorted for each cell
+} EdgeList;
+
+#define FLOW_GRAPH_KINDS 4
+
+static const int FLOW_SUCCESSORS        = 0; // dreg_successors_normal_flow
+static const int FLOW_PREDECESSORS      = 1; // dreg_predecessors_normal_flow
+static const int FLOW_JMP_DESTINATIONS  = 2; // dreg_jmp_destinations
+static const int FLOW_MOVD_DESTINATIONS = 3; // dreg_movd_destinations
+
+typedef struct FlowGraph {
+	struct EdgeList edges[FLOW_GRAPH_KINDS];
+} FlowGraph;
+
+// coverage features of an analysis (corpus.c): the edges as in the edge log (kind << 32 | cell << 16 | target) and the
+// access flags as FEATURE_ACCESS_FLAG << 32 | cell << 16 | flag
+static const int FEATURE_ACCESS_FLAG = 3;
+
+typedef struct CoverageFeatures {
+	unsigned long long* features; // sorted
+	size_t length;
+} CoverageFeatures;
+
+// attribution index of the features to the inputs that produce them, as compressed sparse rows like EdgeList:
+// features[i] is produced by inputs[offsets[i]..offsets[i+1]-1]
+typedef struct CoverageAttribution {
+	unsigned long long* features; // sorted union of the features of all inputs
+	size_t number_of_features;
+	size_t* offsets;
+	int* inputs; // ascending for each feature
+} CoverageAttribution;
+
+// ternary word as trit planes: bit k is set in ones (twos) if the k-th trit is 1 (2)
+typedef struct TritWord {
+	unsigned short ones;
+	unsigned short twos;
+} TritWord;
+
+#define TRIT_WORD_MASK 0x3ff
+
+// input of a Malbolge program. input read from the terminal is recorded into a buffer that grows geometrically
+// (capacity > 0); replayed input points into a transcript file and is consumed in place (capacity == 0).
 typedef struct UserInput {
-	int length;
-	int* input;
+	unsigned char* input;
+	size_t length;
+	size_t capacity; // 0 if the input is not owned
+	int eof; // EOF is read after the input; otherwise the run stops when it asks for more input
 } UserInput;
 
-const int MALBOLGE_HLT = 0x0001;
-const int MALBOLGE_JMP = 0x0002;
-const int MALBOLGE_MOV = 0x0004;
-const int MALBOLGE_OPR = 0x0008;
-const int MALBOLGE_OUT = 0x0010;
-const int MALBOLGE_IN  = 0x0020;
-const int MALBOLGE_ROT = 0x0040;
-const int MALBOLGE_NOP = 0x0080;
-
+// input file mapped into memory (transcript.c)
+typedef struct TranscriptFile {
+	void* mapping;
+	size_t mapping_length;
+	struct UserInput input; // points into the mapping
+	int has_output; // the Malbolge program has halted after the input when it has been recorded
+	unsigned long long output_hash; // OutputSink hash and length of the recorded output
+	unsigned long long output_length;
+	int node; // of the transcript trie that ends the input
+	int output_verified; // 1: the replay has produced the recorded output, -1: different output, 0: not checked
+} TranscriptFile;
+
+// receives the output of a Malbolge program (transcript.c). the kinds can be combined; without any kind the output is
+// discarded.
+static const int OUTPUT_STDOUT  = 0x01; // buffered and handed to stdout at line ends, when the buffer is full and on flush
+static const int OUTPUT_CAPTURE = 0x02; // kept in memory
+static const int OUTPUT_HASH    = 0x04; // FNV-1a hash, e.g. to compare the output with a recorded one
+
+#define OUTPUT_BUFFER_SIZE 4096
+#define TRANSCRIPT_SHOWN_OUTPUT 256 // characters of the output shown if it differs from the recorded one
+#define OUTPUT_HASH_BASIS 0xcbf29ce484222325ULL
+
+typedef struct OutputSink {
+	int kinds;
+	unsigned char buffer[OUTPUT_BUFFER_SIZE]; // OUTPUT_STDOUT
+	size_t buffered;
+	struct UserInput captured; // OUTPUT_CAPTURE
+	unsigned long long hash; // OUTPUT_HASH
+	unsigned long long length; // characters written
+	int failed; // out of memory or stdout cannot be written
+} OutputSink;
+
+// state of an analysis run that has to be kept if the run is continued by another call of execute
+typedef struct ExecutionContinuation {
+	long long steps; // steps executed since the entry point
+	int last_accessed_d_pos;
+} ExecutionContinuation;
+
+// input files sharing a common prefix share a path from the root; nodes are stored in a single array.
+// a node holds the input up to the next point where the input files diverge; it points into the mapped input file
+// it has been read from first. EOF is a node of its own without input and without children.
+typedef struct TranscriptNode {
+	unsigned char* input;
+	size_t length;
+	int eof; // EOF is read for good
+	int terminal; // end of an input file
+	int first_child; // index or -1
+	int next_sibling; // index or -1
+} TranscriptNode;
+
+typedef struct TranscriptTrie {
+	struct TranscriptNode* nodes; // nodes[0] is the root; it has no input
+	int number_of_nodes;
+	int capacity;
+	int number_of_transcripts;
+	struct TranscriptFile* files; // the nodes point into them
+	int recorded_outputs; // files with recorded output; the lanes hash their output only if there are any
+} TranscriptTrie;
+
+static const int MALBOLGE_HLT = 0x0001;
+static const int MALBOLGE_JMP = 0x0002;
+static const int MALBOLGE_MOV = 0x0004;
+static const int MALBOLGE_OPR = 0x0008;
+static const int MALBOLGE_OUT = 0x0010;
+static const int MALBOLGE_IN  = 0x0020;
+static const int MALBOLGE_ROT = 0x0040;
+static const int MALBOLGE_NOP = 0x0080;
+
+// precomputed per (value-33, position%94) for the valid value range 33..126
+typedef struct XlatCycleInfo {
+	unsigned char valid; // accepted by the loader at this position
+	unsigned char cycle_length; // length of the xlat cycle the value belongs to
+	unsigned char pure_nop_cycle; // every element of the xlat cycle decodes to a NOP at this position
+	unsigned char text_length;
+	char text[48]; // xlat cycle as printed into HeLL code, e.g. "Rot/Nop", "RNop" or "Invalid"
+} XlatCycleInfo;
+
+// whether cell is set in a bitmap of MD_BREAKPOINT_BITMAP_SIZE bytes
+#define BREAKPOINT_SET(bitmap, cell) ((bitmap)[(cell)>>3] & (1 << ((cell)&7)))
+
+// the fields after command_mask are 0 if a BreakCondition is initialized by {0, 0, 0}.
+// breaking leaves the state before the command; a run that continues has to execute this command without breakpoints.
 typedef struct BreakCondition {
-	int maximal_steps; // less or equal zero: don't break
+	long long maximal_steps; // less or equal zero: don't break
 	int on_cseg_outside_analysis; // break if AccessAnalysis is set and a memory cell is firstly used as command (pointed to by cseg). only used for advanced entry point analysis. ; therefore, also break if later CSEG-memory-cells are modified
 	int command_mask; // break on malbolge commands (before executing them)
+	const unsigned char* on_c; // bitmap: break on the commands at these addresses (optional)
+	const unsigned char* on_read; // bitmap: break on JMP, MOVD, ROT and OPR if they read memory[d] of these cells (optional)
+	const unsigned char* on_write; // bitmap: break on ROT and OPR if they write memory[d] of these cells (optional)
+	int on_register; // MD_REGISTER_*: the breakpoints above only break if this register has register_value;
+	                 // without them, break whenever it has this value. 0: no condition
+	int register_value;
 } BreakCondition;
 
 
 
+// kinds of recorded execution events.
+// every event starts with a byte: kind in the low nibble, number of steps since the previous event in the high nibble
+// (EVENT_STEP_DELTA_VARINT: the number of steps follows as varint). payloads are varints:
+// BEGIN: a, c, d; JMP: new c; MOVD: new d; OUT: a; IN: a; END: number of steps of the run. ROT, OPR, HLT: none.
+// c and d of every event can be reconstructed from the BEGIN, JMP and MOVD events, because both registers are
+// incremented by one in all other steps.
+static const int EVENT_BEGIN = 0;
+static const int EVENT_END   = 1;
+static const int EVENT_JMP   = 2;
+static const int EVENT_MOVD  = 3;
+static const int EVENT_ROT   = 4;
+static const int EVENT_OPR   = 5;
+static const int EVENT_OUT   = 6;
+static const int EVENT_IN    = 7;
+static const int EVENT_HLT   = 8;
+static const int EVENT_STEP_DELTA_VARINT = 15;
+
+typedef struct EventTrace {
+	FILE* file; // events are streamed into file; if not set, they are stored in buffer
+	unsigned char* buffer;
+	size_t length;
+	size_t capacity;
+	long long steps; // steps of the current run executed so far
+	long long last_event_step;
+	int failed; // write error or out of memory
+} EventTrace;
+
+typedef struct EventTraceReader {
+	const unsigned char* data;
+	size_t length;
+	size_t position;
+	void* mapping; // mmap'ed trace file
+	size_t mapping_length;
+	long long step; // step of the last event read
+	long long sync_step;
+	int sync_c, sync_d; // registers at sync_step; no JMP or MOVD in between
+} EventTraceReader;
+
+typedef struct ExecutionEvent {
+	int kind;
+	long long step; // number of steps executed before since begin of the run
+	int c, d; // registers before the command is executed
+	int value; // payload
+} ExecutionEvent;
+
+// arguments and local state of execute; allows to execute a program step by step
+typedef struct ExecutionContext {
+	struct VMState* state;
+	int interactive;
+	struct UserInput* input;
+	struct OutputSink* output; // 0: the output is discarded
+	struct BreakCondition break_on;
+	int breakpoints; // break_on has breakpoints or a register condition
+	long long* last_jmp;
+	int* interrupted;
+	struct AccessAnalysis* accesses;
+	int access_analysis_ro;
+	struct EventTrace* events;
+	long long steps;
+	size_t input_pos;
+	int first_d_pos;
+	int* last_accessed_d_pos; // first_d_pos or kept in an ExecutionContinuation
+	struct ExecutionContinuation* continuation; // or 0
+	long long* first_executed; // of accesses if they are recorded, otherwise 0
+	int continued;
+	int c_mod94; // state->c%94, maintained incrementally to decode commands by table lookup
+	unsigned int last_coverage; // accesses->coverage when it has changed the last time
+	long long last_coverage_step;
+	int coverage_changed; // since the clock has been read the last time
+	time_t last_coverage_time;
+	long long charged_steps; // steps charged to the ResourceBudget
+	int paused; // stopped by poll_execution: interrupted, out of budget or a checkpoint is due
+} ExecutionContext;
+
+
+
+// number of Malbolge programs executed interleaved on one core
+#define EXECUTION_LANES 8
+
+// program that waits for the input of node, after fed characters of it have been read already
+typedef struct TranscriptBranch {
+	int node;
+	size_t fed;
+	struct VMState* state;
+	struct ExecutionContinuation continuation;
+	unsigned long long output_hash; // of the output so far
+	unsigned long long output_length;
+} TranscriptBranch;
+
+// snapshot of a transcript analysis that is written to disk periodically (checkpoint.c). an analysis that has been
+// interrupted, stopped by a limit or killed continues from its last checkpoint.
+typedef struct Checkpoint {
+	const char* filename;
+	int interval; // seconds between two checkpoints
+	time_t next; // time of the next checkpoint
+	int due; // the runs stop at the next poll, so they can be stored
+	int failed; // a checkpoint could not be written
+	unsigned long long key; // of the Malbolge program and the input files; a checkpoint of other files is not loaded
+	long long steps_to_entrypoint;
+	const struct VMState* entry_state;
+	struct TranscriptBranch* runs; // loaded runs that have not been finished yet
+	int number_of_runs;
+} Checkpoint;
+
+typedef struct TranscriptLane {
+	struct ExecutionContext context;
+	struct VMState* state;
+	struct ExecutionContinuation continuation;
+	struct UserInput input; // points into the input of node
+	int node; // input currently fed
+	size_t fed; // characters of the input of node read before the current context
+	struct OutputSink output; // OUTPUT_HASH
+	int interrupted;
+	int active;
+} TranscriptLane;
+
+
+
+#define TRACE_MAX_LENGTH 256
+#define TRACE_CACHE_BUCKETS 4096
+#define TRACE_CACHE_MAX_TRACES 65536
+#define JIT_HOT_THRESHOLD 8 // replays of a trace before it is compiled to native code
+#define JIT_CODE_SIZE (4*1024*1024)
+
+// straight-line run of NOP, ROT and OPR commands between JMP/MOVD/IN/OUT/HLT.
+// the trace is valid whenever memory[c..c+length-1] equals code.
+typedef struct Trace {
+	int c; // address of first command; traces never wrap around 59048 -> 0
+	int length;
+	int has_data_writes; // contains ROT or OPR
+	int* code; // guard: memory contents the trace was recorded for
+	int* encrypted; // memory contents after the commands have been executed (if not overwritten by ROT/OPR)
+	unsigned char* commands; // decoded commands: 39 (ROT), 62 (OPR) or 68 (NOP)
+	int hits; // number of replays, counted up to JIT_HOT_THRESHOLD
+	int compile_failed; // compile_trace has failed, e.g. because the code region is full; the trace is not compiled again
+	void (*native)(struct VMState* state); // compiled trace or 0
+	struct Trace* next; // next trace in hash bucket
+} Trace;
+
+typedef struct TraceCache {
+	int number_of_traces;
+	int use_jit; // compile hot traces to native code (x86-64 only)
+	unsigned char* jit_code;
+	size_t jit_used;
+	struct Trace* buckets[TRACE_CACHE_BUCKETS]; // hashed by c
+} TraceCache;
+
+// number of cells listed by the memory diff of a divergence found by check_engines
+#define LOCKSTEP_DIFF_CELLS 8
+
+// an execution engine that is checked against execute, and its run on the same program and input
+typedef struct LockstepEngine {
+	const char* name;
+	struct TraceCache* cache; // execute_traced with this cache
+	struct VMState* state;
+	size_t input_pos; // characters of the input read so far
+	long long steps; // executed by the last call of run_lockstep_engine
+} LockstepEngine;
+
+
+
 typedef struct ConnectedMemoryCells {
 	int fixed_offset;
 	int codesection;
 	int datasection;
-	struct avl_table* cells; // contains their addresses as integer
+	int* cells; // addresses in circular order, see set_circular_cell_order
+	int number_of_cells;
 } ConnectedMemoryCells;
 
+// growing character buffer; failed is set if memory has run out
+typedef struct TextBuffer {
+	char* data;
+	size_t length;
+	size_t capacity;
+	int failed;
+} TextBuffer;
+
+void init_text_buffer(struct TextBuffer* text);
+void free_text_buffer(struct TextBuffer* text);
+int reserve_text_buffer(struct TextBuffer* text, size_t length);
+void buffer_write(struct TextBuffer* text, const char* data, size_t length);
+void buffer_puts(struct TextBuffer* text, const char* data);
+void buffer_printf(struct TextBuffer* text, const char* format, ...);
+int write_text_buffer(FILE* file, struct TextBuffer* text); // writes the buffer and frees it; 1 if it is incomplete
+
+// lines of the HeLL file that belong to a memory cell, for the debug information (debuginfo.c)
+static const int DEBUG_CODE_LABEL = 1; // CODE_n:
+static const int DEBUG_DATA_LABEL = 2; // DATA_n:
+static const int DEBUG_COMMAND    = 3; // command of a .CODE block
+static const int DEBUG_DATA_WORD  = 4; // word of a .DATA block, or ?- for an unused cell between two words
+
+typedef struct DebugRecord {
+	long long line; // offset of the line in the TextBuffer of its block while it is formatted, then line in the HeLL file (from 1)
+	int address;
+	int kind; // DEBUG_*
+	int component; // index of the block in creg_components or dreg_components
+	int data; // the block is a .DATA block
+	int xlat_cycle; // length of the xlat cycle of the cell's value at its address; 0 if it is no valid command
+	long long first_executed; // step at which the cell has been executed first, or -1
+} DebugRecord;
+
+typedef struct DebugRecords {
+	struct DebugRecord* records; // in the order of their lines
+	size_t length;
+	size_t capacity;
+	int failed; // memory has run out
+} DebugRecords;
+
+int add_debug_record(struct DebugRecords* debug, long long line, int kind, int address, int xlat_cycle, long long first_executed);
+int append_debug_records(struct DebugRecords* debug, const struct DebugRecords* block, int component, int data);
+void free_debug_records(struct DebugRecords* debug);
+int write_debug_info(const char* filename, const struct DebugRecords* debug);
+
+// blocks are formatted in parallel by up to MAX_EMITTER_THREADS threads
+#define MAX_EMITTER_THREADS 16
+
+typedef struct EmitterJob {
+	const struct ConnectedMemoryCells* block;
+	int data; // .DATA block, otherwise .CODE block
+	struct TextBuffer text;
+	struct DebugRecords debug; // lines of text that belong to a memory cell, if the debug information is written
+} EmitterJob;
+
+typedef struct BlockEmitter {
+	struct EmitterJob* jobs;
+	int number_of_jobs;
+	int next_job; // first job not taken by a worker yet
+#ifndef WINDOWS
+	pthread_mutex_t lock; // protects next_job
+#endif
+	const struct AccessAnalysis* accesses;
+	const struct VMState* entry_state;
+	int debug; // collect the DebugRecords of the jobs
+} BlockEmitter;
+
+// check_crazy compares 59049 rows of 10-trit operands and CRAZY_CHECK_HIGH_ROWS rows with operands above 10 trits;
+// the rows are compared in parallel by up to MAX_EMITTER_THREADS threads
+#define CRAZY_CHECK_HIGH_ROWS 6
+
+typedef struct CrazyCheck {
+	int next_row; // first row not taken by a worker yet
+	int failed; // crazy differs from the reference for the operands a and d
+	unsigned int a;
+	unsigned int d;
+#ifndef WINDOWS
+	pthread_mutex_t lock; // protects next_row and failed
+#endif
+} CrazyCheck;
+
+// allocations reused by the disassemble calls of a Disassembler
+typedef struct DisassemblerBuffers {
+	struct VMState* initial_state;
+	struct VMState* entry_state;
+	struct AccessAnalysis* accesses; // reset after every call
+} DisassemblerBuffers;
+
+// daemon mode (server.c)
+#define MAX_SERVER_WORKERS 16
+#define SERVER_QUEUE_LENGTH 256 // connections waiting for a worker
+#define SERVER_CACHE_ENTRIES 1024
+#define SERVER_CACHE_BYTES (256*1024*1024)
+
+typedef struct ServerJob {
+	char* program;
+	char* output;
+	char* graph; // optional
+	char* checkpoint; // optional
+	char** inputs; // zero-terminated
+	int number_of_inputs;
+	int use_jit; // -1 if the job does not set it, then the default of the server
+	struct CoverageLimits limits;
+	struct ResourceBudget budget;
+	char id[64]; // JSON value; empty if not given
+} ServerJob;
+
+// output files of a job, found by the contents of its program and input files and its options
+typedef struct CachedResult {
+	char* key; // 0 if the entry is unused
+	size_t key_length;
+	unsigned long long hash; // of key
+	char* hell;
+	size_t hell_length;
+	char* graph; // 0 if the job has not asked for it
+	size_t graph_length;
+	int partial; // a budget has been exhausted
+	unsigned long long last_used;
+} CachedResult;
+
+typedef struct ResultCache {
+	struct CachedResult entries[SERVER_CACHE_ENTRIES];
+	size_t bytes;
+	unsigned long long clock;
+#ifndef WINDOWS
+	pthread_mutex_t lock;
+#endif
+} ResultCache;
+
+typedef struct ServerQueue {
+	int connections[SERVER_QUEUE_LENGTH];
+	int first;
+	int length;
+#ifndef WINDOWS
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+#endif
+} ServerQueue;
+
+typedef struct ServerWorker {
+	struct Disassembler disassembler; // its buffers are reused by all jobs of the worker
+	const struct Disassembler* defaults; // options of the command line
+	struct ResultCache* cache;
+	struct ServerQueue* queue;
+#ifndef WINDOWS
+	pthread_t thread;
+#endif
+} ServerWorker;
+
+// serves jobs on the Unix domain socket socket_path, or on stdin and stdout if it is "-"
+int run_server(const char* socket_path, const struct Disassembler* defaults);
+
+// default interval of the checkpoints
+#define CHECKPOINT_SECONDS 60
+
+int checkpoint_key(const char* malbolge_file, char** user_input_files, unsigned long long* key);
+int write_checkpoint(struct Checkpoint* checkpoint, struct AccessAnalysis* accesses, const struct TranscriptBranch* runs, int number_of_runs);
+int load_checkpoint(struct Checkpoint* checkpoint, struct VMState* entry_state, struct AccessAnalysis* accesses);
+void remove_checkpoint(struct Checkpoint* checkpoint);
+void free_checkpoint_runs(struct Checkpoint* checkpoint);
+
+// coverage attribution and minimization of the input files (corpus.c)
+int collect_coverage_features(struct AccessAnalysis* accesses, struct CoverageFeatures* features);
+void free_coverage_features(struct CoverageFeatures* features);
+int build_coverage_attribution(const struct CoverageFeatures* inputs, int number_of_inputs, struct CoverageAttribution* attribution);
+void free_coverage_attribution(struct CoverageAttribution* attribution);
+size_t count_unique_features(const struct CoverageAttribution* attribution, const struct CoverageFeatures* input, int index);
+int minimize_coverage(const struct CoverageAttribution* attribution, const struct CoverageFeatures* inputs, int number_of_inputs,
+		const size_t* costs, int* selected, size_t* gains);
+
+// transcript files of the input of analysis runs (transcript.c)
+int open_transcript_file(struct TranscriptFile* transcript, const char* filename);
+void close_transcript_file(struct TranscriptFile* transcript);
+int save_transcript_file(const char* filename, const struct UserInput* input, const struct OutputSink* output);
+int append_user_input(struct UserInput* input, unsigned char value);
+void free_user_input(struct UserInput* input);
+void init_output_sink(struct OutputSink* sink, int kinds);
+void drain_output(struct OutputSink* sink);
+void write_output(struct OutputSink* sink, unsigned char value);
+void flush_output(struct OutputSink* sink);
+void restart_output_hash(struct OutputSink* sink);
+void free_output_sink(struct OutputSink* sink);
+
+// the SIGINT handler replaced during the analysis runs
+typedef struct SigintHandler {
+	int installed;
+#ifndef WINDOWS
+	struct sigaction old_action;
+#endif
+} SigintHandler;
 
 
 int got_sigint();
+int charge_budget(long long steps, const struct AccessAnalysis* accesses);
+int out_of_budget();
+
+void init_instruction_tables();
+void init_trit_tables();
+struct TritWord to_trits(unsigned int value);
+unsigned int from_trits(struct TritWord word);
+struct TritWord crazy_trits(struct TritWord a, struct TritWord d);
 
 void copy_state(struct VMState* dest, const struct VMState* src);
 
-// if interactive is true:  output will be written to terminal; input will be read from terminal and returned by input (if not NULL). break_on: CTRL+C, break_on-Conditions
+// if interactive is true:  output will be written to terminal (disassembler->terminal_output); input will be read from terminal and returned by input (if not NULL). break_on: CTRL+C, break_on-Conditions
 // if interactive is false: output will be discarded; input will be taken from input (if not NULL), otherwise EOF will be read all the time. will only break on HALT command and break_on-Conditions
 // return value: number of steps executed
 // VMState start will be modified during execution!
-int execute(struct VMState* start, int interactive, struct UserInput* input, struct BreakCondition break_on, int* last_jmp, int* interrupted, struct AccessAnalysis* accesses, int access_analysis_ro);
-
+// if events is set, all commands that may change the control flow or access data or I/O are recorded there.
+long long execute(struct VMState* start, int interactive, struct UserInput* input, struct BreakCondition break_on, long long* last_jmp, int* interrupted, struct AccessAnalysis* accesses, int access_analysis_ro, struct EventTrace* events);
+
+// same semantics as execute without access analysis and without recorded input (input is read from terminal if interactive, otherwise IN breaks).
+// replays cached traces of straight-line code and falls back to execute for all other commands.
+long long execute_traced(struct TraceCache* cache, struct VMState* state, int interactive, struct BreakCondition break_on, long long* last_jmp, int* interrupted, struct EventTrace* events);
+
+struct TraceCache* create_trace_cache(int use_jit);
+void free_trace_cache(struct TraceCache* cache);
+
+int build_transcript_trie(struct Disassembler* disassembler, struct TranscriptTrie* trie, char** user_input_files);
+void free_transcript_trie(struct TranscriptTrie* trie);
+long long continue_execution(struct VMState* state, struct UserInput* input, int* interrupted, struct AccessAnalysis* accesses,
+		struct ExecutionContinuation* continuation);
+int execute_interleaved(struct ExecutionContext** contexts, int number_of_contexts);
+
+void init_event_trace(struct EventTrace* events, FILE* file); // file may be 0 to record into memory
+void free_event_trace(struct EventTrace* events);
+void begin_event_trace_run(struct EventTrace* events, const struct VMState* state);
+void end_event_trace_run(struct EventTrace* events);
+int open_event_trace_buffer(struct EventTraceReader* reader, const struct EventTrace* events);
+int open_event_trace_file(struct EventTraceReader* reader, FILE* file);
+void close_event_trace_reader(struct EventTraceReader* reader);
+int read_event(struct EventTraceReader* reader, struct ExecutionEvent* event);
+
+void flush_edge_log(struct AccessAnalysis* accesses);
+void apply_edge(struct AccessAnalysis* accesses, unsigned long long edge);
+struct avl_table** edge_set_of_kind(struct MemoryCellInfo* cell, int kind);
 void copy_access_analysis(struct AccessAnalysis* dest, struct AccessAnalysis* src);
+void reset_access_analysis(struct AccessAnalysis* access); // releases the edge sets, keeps the edge log and first_executed
 void free_access_analysis(struct AccessAnalysis* access); // only recursive allocations, not the root
 
 #endif
@@ -0,0 +1,869 @@
+/*
+
+	This file is part of the Malbolge disassembler.
+	Copyright (C) 2016 Matthias Lutter
+
+	The Malbolge disassembler is free software: you can redistribute it
+	and/or modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation, either version 3 of
+	the License, or (at your option) any later version.
+
+	The Malbolge disassembler is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+	of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	E-Mail: matthias@lutter.cc
+
+
+
+	For more Malbolge stuff, please visit
+	<https://lutter.cc/>
+
+*/
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+#define WINDOWS
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef WINDOWS
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "main.h"
+
+// daemon mode. jobs are read as JSON lines from a Unix domain socket or from stdin; one result line is written per job:
+//   {"id": 1, "program": "a.mb", "output": "a.hell", "inputs": ["in.txt"], "graph": "a.graph", "jit": true,
+//    "window_steps": 1000, "window_seconds": 10, "deadline_seconds": 60,
+//    "budget_seconds": 30, "budget_steps": 100000000, "budget_megabytes": 512, "checkpoint": "a.checkpoint"}
+//   {"id": 1, "result": 0, "cached": false, "partial": false}
+// program, output and inputs are required; the interactive analysis is not available. id is optional and copied.
+// the options given on the command line are the defaults of the jobs.
+// the jobs write files with the uid of the server, so only the owner of the server may connect to its socket.
+
+int parse_job(const char* line, struct ServerJob* job);
+void free_job(struct ServerJob* job);
+const char* skip_json_whitespace(const char* text);
+const char* parse_json_string(const char* text, char** value);
+const char* parse_json_number(const char* text, int* value);
+const char* parse_json_long_number(const char* text, long long* value);
+const char* skip_json_value(const char* text);
+int read_line(FILE* file, char** line, size_t* capacity);
+void buffer_json_string(struct TextBuffer* text, const char* value);
+int read_whole_file(const char* filename, char** data, size_t* length);
+int write_whole_file(const char* filename, const char* data, size_t length);
+int build_cache_key(const struct ServerJob* job, struct TextBuffer* key);
+unsigned long long hash_bytes(const char* data, size_t length);
+int lookup_cached_result(struct ResultCache* cache, const struct ServerJob* job, const struct TextBuffer* key, unsigned long long hash, int* partial);
+void store_cached_result(struct ResultCache* cache, const struct ServerJob* job, struct TextBuffer* key, unsigned long long hash, int partial);
+void release_cached_result(struct ResultCache* cache, int entry);
+void run_job(struct ServerWorker* worker, const char* line, struct TextBuffer* response);
+void serve_stream(struct ServerWorker* worker, FILE* in, FILE* out);
+#ifndef WINDOWS
+void* server_worker(void* argument);
+#endif
+
+int run_server(const char* socket_path, const struct Disassembler* defaults) {
+	struct ResultCache cache;
+	struct ServerWorker* workers = 0;
+	int number_of_workers = 1;
+	int i;
+
+	memset(&cache, 0, sizeof(struct ResultCache));
+#ifndef WINDOWS
+	pthread_mutex_init(&cache.lock, 0);
+#endif
+	if (strcmp(socket_path, "-") == 0) {
+		struct ServerWorker worker;
+		memset(&worker, 0, sizeof(struct ServerWorker));
+		worker.defaults = defaults;
+		worker.cache = &cache;
+		init_disassembler(&worker.disassembler);
+		serve_stream(&worker, stdin, stdout);
+		free_disassembler(&worker.disassembler);
+		for (i=0;i<SERVER_CACHE_ENTRIES;i++) {
+			release_cached_result(&cache, i);
+		}
+		return 0;
+	}
+#ifndef WINDOWS
+	{
+		struct sockaddr_un address;
+		struct stat status;
+		struct ServerQueue queue;
+		long processors = sysconf(_SC_NPROCESSORS_ONLN);
+		int listener;
+		int bound = 0;
+		mode_t old_mask;
+
+		if (strlen(socket_path) >= sizeof(address.sun_path)) {
+			fprintf(stderr,"Socket path too long: %s\n",socket_path);
+			return 1;
+		}
+		memset(&address, 0, sizeof(struct sockaddr_un));
+		address.sun_family = AF_UNIX;
+		strcpy(address.sun_path, socket_path);
+		// a socket left by an earlier server is replaced; other files are not touched
+		if (stat(socket_path, &status) == 0 && S_ISSOCK(status.st_mode)) {
+			unlink(socket_path);
+		}
+		listener = socket(AF_UNIX, SOCK_STREAM, 0);
+		// the socket is created with mode 0600; a chmod after bind would leave it open to other users for a moment
+		old_mask = umask(077);
+		if (listener >= 0) {
+			bound = (bind(listener, (struct sockaddr*)&address, sizeof(struct sockaddr_un)) == 0);
+		}
+		umask(old_mask);
+		if (!bound || listen(listener, SOMAXCONN) != 0) {
+			fprintf(stderr,"Cannot listen on socket: %s\n",socket_path);
+			if (listener >= 0) {
+				close(listener);
+			}
+			return 1;
+		}
+		// a client that disconnects early must not terminate the server
+		signal(SIGPIPE, SIG_IGN);
+
+		if (processors > 1) {
+			number_of_workers = (processors > MAX_SERVER_WORKERS ? MAX_SERVER_WORKERS : (int)processors);
+		}
+		workers = (struct ServerWorker*)malloc(sizeof(struct ServerWorker)*number_of_workers);
+		if (!workers) {
+			fprintf(stderr,"Not enough memory.\n");
+			close(listener);
+			return 1;
+		}
+		memset(&queue, 0, sizeof(struct ServerQueue));
+		pthread_mutex_init(&queue.lock, 0);
+		pthread_cond_init(&queue.not_empty, 0);
+		for (i=0;i<number_of_workers;i++) {
+			memset(&workers[i], 0, sizeof(struct ServerWorker));
+			workers[i].defaults = defaults;
+			workers[i].cache = &cache;
+			workers[i].queue = &queue;
+			init_disassembler(&workers[i].disassembler);
+			if (pthread_create(&workers[i].thread, 0, server_worker, &workers[i]) != 0) {
+				break;
+			}
+		}
+		if (i == 0) {
+			fprintf(stderr,"Cannot start worker threads.\n");
+			close(listener);
+			free(workers);
+			return 1;
+		}
+		printf("Waiting for jobs on %s.\n",socket_path);
+		fflush(stdout);
+
+		// the server runs until it is killed
+		while (1) {
+			int connection = accept(listener, 0, 0);
+			if (connection < 0) {
+				continue;
+			}
+			pthread_mutex_lock(&queue.lock);
+			if (queue.length == SERVER_QUEUE_LENGTH) {
+				// all workers are busy and the queue is full
+				pthread_mutex_unlock(&queue.lock);
+				close(connection);
+				continue;
+			}
+			queue.connections[(queue.first + queue.length) % SERVER_QUEUE_LENGTH] = connection;
+			queue.length++;
+			pthread_cond_signal(&queue.not_empty);
+			pthread_mutex_unlock(&queue.lock);
+		}
+	}
+#else
+	fprintf(stderr,"Unix domain sockets are not supported on this platform. Use -s - to read the jobs from stdin.\n");
+	return 1;
+#endif
+}
+
+#ifndef WINDOWS
+// takes connections from the queue; each worker keeps its own Disassembler, so its buffers are reused for all jobs
+void* server_worker(void* argument) {
+	struct ServerWorker* worker = (struct ServerWorker*)argument;
+	struct ServerQueue* queue = worker->queue;
+	while (1) {
+		int connection;
+		FILE* in;
+		FILE* out;
+		pthread_mutex_lock(&queue->lock);
+		while (queue->length == 0) {
+			pthread_cond_wait(&queue->not_empty, &queue->lock);
+		}
+		connection = queue->connections[queue->first];
+		queue->first = (queue->first + 1) % SERVER_QUEUE_LENGTH;
+		queue->length--;
+		pthread_mutex_unlock(&queue->lock);
+
+		in = fdopen(connection, "r");
+		out = in ? fdopen(dup(connection), "w") : 0;
+		if (!in || !out) {
+			if (in) {
+				fclose(in);
+			}else{
+				close(connection);
+			}
+			continue;
+		}
+		serve_stream(worker, in, out);
+		fclose(out);
+		fclose(in);
+	}
+	return 0;
+}
+#endif
+
+// answers the jobs read from in until the end of in
+void serve_stream(struct ServerWorker* worker, FILE* in, FILE* out) {
+	char* line = 0;
+	size_t capacity = 0;
+	while (read_line(in, &line, &capacity)) {
+		struct TextBuffer response;
+		const char* text = skip_json_whitespace(line);
+		if (!*text) {
+			continue;
+		}
+		init_text_buffer(&response);
+		run_job(worker, text, &response);
+		buffer_puts(&response, "\n");
+		if (write_text_buffer(out, &response) || fflush(out) != 0) {
+			break;
+		}
+	}
+	if (line) {
+		free(line);
+	}
+}
+
+void run_job(struct ServerWorker* worker, const char* line, struct TextBuffer* response) {
+	struct ServerJob job;
+	struct Disassembler* disassembler = &worker->disassembler;
+	struct TextBuffer key;
+	unsigned long long hash = 0;
+	int cacheable = 0;
+	int cached = 0;
+	int partial = 0;
+	int result = MD_OK;
+	const char* error = 0;
+
+	init_text_buffer(&key);
+	if (parse_job(line, &job)) {
+		result = MD_ERROR_ARGUMENTS;
+		error = "Invalid job.";
+	}else if (!job.program || !job.output || !job.inputs) {
+		result = MD_ERROR_ARGUMENTS;
+		error = "A job needs a program, an output file and at least one input file.";
+	}else{
+		if (job.use_jit < 0) {
+			job.use_jit = worker->defaults->use_jit;
+		}
+		if (!job.limits.window_steps) {
+			job.limits.window_steps = worker->defaults->limits.window_steps;
+		}
+		if (!job.limits.window_seconds) {
+			job.limits.window_seconds = worker->defaults->limits.window_seconds;
+		}
+		if (!job.limits.deadline_seconds) {
+			job.limits.deadline_seconds = worker->defaults->limits.deadline_seconds;
+		}
+		if (!job.budget.deadline_seconds) {
+			job.budget.deadline_seconds = worker->defaults->budget.deadline_seconds;
+		}
+		if (!job.budget.maximal_steps) {
+			job.budget.maximal_steps = worker->defaults->budget.maximal_steps;
+		}
+		if (!job.budget.maximal_memory) {
+			job.budget.maximal_memory = worker->defaults->budget.maximal_memory;
+		}
+		// results of runs limited by time depend on the speed of the machine; resumed runs depend on the checkpoint
+		cacheable = !job.limits.window_seconds && !job.limits.deadline_seconds && !job.budget.deadline_seconds && !job.checkpoint &&
+				!build_cache_key(&job, &key);
+		if (cacheable) {
+			hash = hash_bytes(key.data, key.length);
+			cached = lookup_cached_result(worker->cache, &job, &key, hash, &partial);
+		}
+		if (!cached) {
+			disassembler->use_jit = job.use_jit;
+			disassembler->limits = job.limits;
+			disassembler->budget = job.budget;
+			disassembler->user_input_files = job.inputs;
+			disassembler->graph_filename = job.graph;
+			disassembler->checkpoint_filename = job.checkpoint;
+			disassembler->checkpoint_seconds = worker->defaults->checkpoint_seconds;
+			disassembler->handle_sigint = 0;
+			disassembler->progress = 0;
+			result = disassemble(disassembler, job.program, job.output);
+			partial = (disassembler->budget_exhausted != 0);
+			if (result != MD_OK) {
+				error = disassembler->error_message;
+			}else if (cacheable) {
+				store_cached_result(worker->cache, &job, &key, hash, partial);
+			}
+		}
+	}
+
+	buffer_puts(response, "{");
+	if (job.id[0]) {
+		buffer_printf(response, "\"id\": %s, ", job.id);
+	}
+	buffer_printf(response, "\"result\": %d, \"cached\": %s, \"partial\": %s", result, cached?"true":"false", partial?"true":"false");
+	if (error) {
+		buffer_puts(response, ", \"error\": ");
+		buffer_json_string(response, error);
+	}
+	buffer_puts(response, "}");
+	free_text_buffer(&key);
+	free_job(&job);
+}
+
+
+// the key is everything the result depends on: the options and the contents of the program and the input files.
+// returns 1 if a file cannot be read; the job is not cached then.
+int build_cache_key(const struct ServerJob* job, struct TextBuffer* key) {
+	int i;
+	buffer_printf(key, "%d %d %lld %lu %d %d\n", job->use_jit, job->limits.window_steps, job->budget.maximal_steps,
+			(unsigned long)job->budget.maximal_memory, job->graph?1:0, job->number_of_inputs);
+	for (i=-1;i<job->number_of_inputs;i++) {
+		char* data = 0;
+		size_t length = 0;
+		if (read_whole_file(i < 0 ? job->program : job->inputs[i], &data, &length)) {
+			return 1;
+		}
+		buffer_printf(key, "%lu\n", (unsigned long)length);
+		buffer_write(key, data, length);
+		free(data);
+	}
+	return key->failed;
+}
+
+// FNV-1a
+unsigned long long hash_bytes(const char* data, size_t length) {
+	unsigned long long hash = 0xcbf29ce484222325ULL;
+	size_t i;
+	for (i=0;i<length;i++) {
+		hash ^= (unsigned char)data[i];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+// writes the cached result of the job to its output files. returns 1 if there has been one.
+// the files are written from a copy of the entry, so the other workers do not wait for them.
+int lookup_cached_result(struct ResultCache* cache, const struct ServerJob* job, const struct TextBuffer* key, unsigned long long hash, int* partial) {
+	struct CachedResult copy;
+	int i;
+	int found = 0;
+	memset(&copy, 0, sizeof(struct CachedResult));
+#ifndef WINDOWS
+	pthread_mutex_lock(&cache->lock);
+#endif
+	for (i=0;i<SERVER_CACHE_ENTRIES;i++) {
+		struct CachedResult* entry = &cache->entries[i];
+		if (entry->key && entry->hash == hash && entry->key_length == key->length && memcmp(entry->key, key->data, key->length) == 0) {
+			copy.hell = (char*)malloc(entry->hell_length > 0 ? entry->hell_length : 1);
+			copy.hell_length = entry->hell_length;
+			if (job->graph && entry->graph) {
+				copy.graph = (char*)malloc(entry->graph_length > 0 ? entry->graph_length : 1);
+				copy.graph_length = entry->graph_length;
+			}
+			if (copy.hell && (!job->graph || copy.graph)) {
+				memcpy(copy.hell, entry->hell, entry->hell_length);
+				if (copy.graph) {
+					memcpy(copy.graph, entry->graph, entry->graph_length);
+				}
+				entry->last_used = ++cache->clock;
+				copy.partial = entry->partial;
+				found = 1;
+			}
+			break;
+		}
+	}
+#ifndef WINDOWS
+	pthread_mutex_unlock(&cache->lock);
+#endif
+	if (found && (write_whole_file(job->output, copy.hell, copy.hell_length) ||
+			(job->graph && write_whole_file(job->graph, copy.graph, copy.graph_length)))) {
+		found = 0;
+	}
+	if (found) {
+		*partial = copy.partial;
+	}
+	if (copy.hell) {
+		free(copy.hell);
+	}
+	if (copy.graph) {
+		free(copy.graph);
+	}
+	return found;
+}
+
+// keeps the output files of the job; the least recently used results are dropped to stay below the limits.
+// the cache takes the key.
+void store_cached_result(struct ResultCache* cache, const struct ServerJob* job, struct TextBuffer* key, unsigned long long hash, int partial) {
+	struct CachedResult result;
+	int i;
+	memset(&result, 0, sizeof(struct CachedResult));
+	if (read_whole_file(job->output, &result.hell, &result.hell_length) ||
+			(job->graph && read_whole_file(job->graph, &result.graph, &result.graph_length))) {
+		if (result.hell) {
+			free(result.hell);
+		}
+		return;
+	}
+	result.key = key->data;
+	result.key_length = key->length;
+	result.hash = hash;
+	result.partial = partial;
+	init_text_buffer(key);
+	if (result.key_length + result.hell_length + result.graph_length > SERVER_CACHE_BYTES) {
+		free(result.key);
+		free(result.hell);
+		if (result.graph) {
+			free(result.graph);
+		}
+		return;
+	}
+#ifndef WINDOWS
+	pthread_mutex_lock(&cache->lock);
+#endif
+	while (1) {
+		int empty = -1;
+		int oldest = -1;
+		for (i=0;i<SERVER_CACHE_ENTRIES;i++) {
+			if (!cache->entries[i].key) {
+				if (empty == -1) {
+					empty = i;
+				}
+			}else if (oldest == -1 || cache->entries[i].last_used < cache->entries[oldest].last_used) {
+				oldest = i;
+			}
+		}
+		if (empty != -1 && cache->bytes + result.key_length + result.hell_length + result.graph_length <= SERVER_CACHE_BYTES) {
+			result.last_used = ++cache->clock;
+			cache->entries[empty] = result;
+			cache->bytes += result.key_length + result.hell_length + result.graph_length;
+			break;
+		}
+		if (oldest == -1) {
+			free(result.key);
+			free(result.hell);
+			if (result.graph) {
+				free(result.graph);
+			}
+			break;
+		}
+		release_cached_result(cache, oldest);
+	}
+#ifndef WINDOWS
+	pthread_mutex_unlock(&cache->lock);
+#endif
+}
+
+// frees an entry of the cache; the caller holds the lock
+void release_cached_result(struct ResultCache* cache, int entry) {
+	struct CachedResult* result;
+	if (entry < 0 || !cache->entries[entry].key) {
+		return;
+	}
+	result = &cache->entries[entry];
+	cache->bytes -= result->key_length + result->hell_length + result->graph_length;
+	free(result->key);
+	free(result->hell);
+	if (result->graph) {
+		free(result->graph);
+	}
+	memset(result, 0, sizeof(struct CachedResult));
+}
+
+int read_whole_file(const char* filename, char** data, size_t* length) {
+	FILE* file = fopen(filename, "rb");
+	size_t capacity = 4096;
+	*data = 0;
+	*length = 0;
+	if (!file) {
+		return 1;
+	}
+	*data = (char*)malloc(capacity);
+	while (*data) {
+		size_t count = fread(*data + *length, 1, capacity - *length, file);
+		*length += count;
+		if (*length < capacity) {
+			break;
+		}
+		capacity *= 2;
+		{
+			char* tmp = (char*)realloc(*data, capacity);
+			if (!tmp) {
+				free(*data);
+				*data = 0;
+			}else{
+				*data = tmp;
+			}
+		}
+	}
+	if (!*data || ferror(file)) {
+		fclose(file);
+		if (*data) {
+			free(*data);
+			*data = 0;
+		}
+		return 1;
+	}
+	fclose(file);
+	return 0;
+}
+
+int write_whole_file(const char* filename, const char* data, size_t length) {
+	FILE* file = fopen(filename, "wb");
+	int failed = 0;
+	if (!file) {
+		return 1;
+	}
+	if (length && fwrite(data, 1, length, file) != length) {
+		failed = 1;
+	}
+	if (fclose(file) != 0) {
+		failed = 1;
+	}
+	return failed;
+}
+
+// reads a line without the line break. returns 0 at the end of file.
+int read_line(FILE* file, char** line, size_t* capacity) {
+	size_t length = 0;
+	int c;
+	while ((c = getc(file)) != EOF && c != '\n') {
+		if (length + 1 >= *capacity) {
+			size_t new_capacity = *capacity ? 2*(*capacity) : 1024;
+			char* tmp = (char*)realloc(*line, new_capacity);
+			if (!tmp) {
+				return 0;
+			}
+			*line = tmp;
+			*capacity = new_capacity;
+		}
+		(*line)[length++] = (char)c;
+	}
+	if (c == EOF && length == 0) {
+		return 0;
+	}
+	if (!*line) {
+		*line = (char*)malloc(1);
+		*capacity = 1;
+		if (!*line) {
+			return 0;
+		}
+	}
+	(*line)[length] = 0;
+	return 1;
+}
+
+
+// returns 1 if line is no valid job. unknown keys are ignored.
+int parse_job(const char* line, struct ServerJob* job) {
+	const char* text = skip_json_whitespace(line);
+	memset(job, 0, sizeof(struct ServerJob));
+	job->use_jit = -1;
+	if (*text != '{') {
+		return 1;
+	}
+	text = skip_json_whitespace(text+1);
+	while (*text != '}') {
+		char* name = 0;
+		text = parse_json_string(text, &name);
+		if (!text) {
+			return 1;
+		}
+		text = skip_json_whitespace(text);
+		if (*text != ':') {
+			free(name);
+			return 1;
+		}
+		text = skip_json_whitespace(text+1);
+		if (strcmp(name, "program") == 0 && !job->program) {
+			text = parse_json_string(text, &job->program);
+		}else if (strcmp(name, "output") == 0 && !job->output) {
+			text = parse_json_string(text, &job->output);
+		}else if (strcmp(name, "graph") == 0 && !job->graph) {
+			text = parse_json_string(text, &job->graph);
+		}else if (strcmp(name, "checkpoint") == 0 && !job->checkpoint) {
+			text = parse_json_string(text, &job->checkpoint);
+		}else if (strcmp(name, "inputs") == 0 && !job->inputs) {
+			int capacity = 4;
+			job->inputs = (char**)malloc(sizeof(char*)*(capacity+1)); // zero-terminated
+			if (!job->inputs || *text != '[') {
+				free(name);
+				return 1;
+			}
+			job->inputs[0] = 0;
+			text = skip_json_whitespace(text+1);
+			while (text && *text != ']') {
+				if (job->number_of_inputs == capacity) {
+					char** tmp = (char**)realloc(job->inputs, sizeof(char*)*(2*capacity+1));
+					if (!tmp) {
+						free(name);
+						return 1;
+					}
+					job->inputs = tmp;
+					capacity *= 2;
+				}
+				text = parse_json_string(text, &job->inputs[job->number_of_inputs]);
+				if (!text) {
+					break;
+				}
+				job->number_of_inputs++;
+				job->inputs[job->number_of_inputs] = 0;
+				text = skip_json_whitespace(text);
+				if (*text == ',') {
+					text = skip_json_whitespace(text+1);
+				}else if (*text != ']') {
+					text = 0;
+				}
+			}
+			if (text) {
+				text++;
+			}
+			if (job->number_of_inputs == 0) {
+				free(job->inputs);
+				job->inputs = 0;
+			}
+		}else if (strcmp(name, "jit") == 0) {
+			if (strncmp(text, "true", 4) == 0) {
+				job->use_jit = 1;
+				text += 4;
+			}else if (strncmp(text, "false", 5) == 0) {
+				job->use_jit = 0;
+				text += 5;
+			}else{
+				text = 0;
+			}
+		}else if (strcmp(name, "window_steps") == 0) {
+			text = parse_json_number(text, &job->limits.window_steps);
+		}else if (strcmp(name, "window_seconds") == 0) {
+			text = parse_json_number(text, &job->limits.window_seconds);
+		}else if (strcmp(name, "deadline_seconds") == 0) {
+			text = parse_json_number(text, &job->limits.deadline_seconds);
+		}else if (strcmp(name, "budget_seconds") == 0) {
+			text = parse_json_number(text, &job->budget.deadline_seconds);
+		}else if (strcmp(name, "budget_steps") == 0) {
+			text = parse_json_long_number(text, &job->budget.maximal_steps);
+		}else if (strcmp(name, "budget_megabytes") == 0) {
+			int megabytes = 0;
+			text = parse_json_number(text, &megabytes);
+			job->budget.maximal_memory = (size_t)megabytes * 1024 * 1024;
+		}else if (strcmp(name, "id") == 0) {
+			// copied into the result as it is
+			const char* end = skip_json_value(text);
+			if (end && (*text == '"' || *text == '-' || (*text >= '0' && *text <= '9')) && (size_t)(end - text) < sizeof(job->id)) {
+				memcpy(job->id, text, end - text);
+				job->id[end - text] = 0;
+			}
+			text = end;
+		}else{
+			text = skip_json_value(text);
+		}
+		free(name);
+		if (!text) {
+			return 1;
+		}
+		text = skip_json_whitespace(text);
+		if (*text == ',') {
+			text = skip_json_whitespace(text+1);
+		}else if (*text != '}') {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void free_job(struct ServerJob* job) {
+	int i;
+	if (job->program) {
+		free(job->program);
+	}
+	if (job->output) {
+		free(job->output);
+	}
+	if (job->graph) {
+		free(job->graph);
+	}
+	if (job->checkpoint) {
+		free(job->checkpoint);
+	}
+	if (job->inputs) {
+		for (i=0;i<job->number_of_inputs;i++) {
+			free(job->inputs[i]);
+		}
+		free(job->inputs);
+	}
+	memset(job, 0, sizeof(struct ServerJob));
+}
+
+const char* skip_json_whitespace(const char* text) {
+	while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') {
+		text++;
+	}
+	return text;
+}
+
+// returns the position behind the string or 0 if there is no valid string. characters above 0x7f in \u escapes become '?'.
+const char* parse_json_string(const char* text, char** value) {
+	char* result;
+	size_t length = 0;
+	*value = 0;
+	if (*text != '"') {
+		return 0;
+	}
+	text++;
+	result = (char*)malloc(strlen(text)+1); // the string cannot get longer by decoding
+	if (!result) {
+		return 0;
+	}
+	while (*text != '"') {
+		char c = *text++;
+		if (c == 0) {
+			free(result);
+			return 0;
+		}
+		if (c == '\\') {
+			c = *text++;
+			switch (c) {
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'n': c = '\n'; break;
+				case 'r': c = '\r'; break;
+				case 't': c = '\t'; break;
+				case '"':
+				case '\\':
+				case '/':
+					break;
+				case 'u':
+					{
+						int code = 0;
+						int k;
+						for (k=0;k<4;k++) {
+							char digit = *text++;
+							if (digit >= '0' && digit <= '9') {
+								code = 16*code + (digit - '0');
+							}else if (digit >= 'a' && digit <= 'f') {
+								code = 16*code + (digit - 'a' + 10);
+							}else if (digit >= 'A' && digit <= 'F') {
+								code = 16*code + (digit - 'A' + 10);
+							}else{
+								free(result);
+								return 0;
+							}
+						}
+						c = (code > 0 && code < 0x80) ? (char)code : '?';
+					}
+					break;
+				default:
+					free(result);
+					return 0;
+			}
+		}
+		result[length++] = c;
+	}
+	result[length] = 0;
+	*value = result;
+	return text+1;
+}
+
+const char* parse_json_number(const char* text, int* value) {
+	char* end = 0;
+	long tmp = strtol(text, &end, 10);
+	if (end == text || tmp < 0 || tmp > 2147483647L) {
+		return 0;
+	}
+	*value = (int)tmp;
+	return end;
+}
+
+const char* parse_json_long_number(const char* text, long long* value) {
+	char* end = 0;
+	long long tmp = strtoll(text, &end, 10);
+	if (end == text || tmp < 0) {
+		return 0;
+	}
+	*value = tmp;
+	return end;
+}
+
+// returns the position behind the value or 0 if there is no valid value
+const char* skip_json_value(const char* text) {
+	if (*text == '"') {
+		char* value = 0;
+		text = parse_json_string(text, &value);
+		if (value) {
+			free(value);
+		}
+		return text;
+	}
+	if (*text == '[' || *text == '{') {
+		char close = (*text == '[') ? ']' : '}';
+		text = skip_json_whitespace(text+1);
+		while (text && *text != close) {
+			if (close == '}') {
+				text = skip_json_value(text);
+				if (!text) {
+					return 0;
+				}
+				text = skip_json_whitespace(text);
+				if (*text != ':') {
+					return 0;
+				}
+				text = skip_json_whitespace(text+1);
+			}
+			text = skip_json_value(text);
+			if (!text) {
+				return 0;
+			}
+			text = skip_json_whitespace(text);
+			if (*text == ',') {
+				text = skip_json_whitespace(text+1);
+			}else if (*text != close) {
+				return 0;
+			}
+		}
+		return text ? text+1 : 0;
+	}
+	if (strncmp(text, "true", 4) == 0 || strncmp(text, "null", 4) == 0) {
+		return text+4;
+	}
+	if (strncmp(text, "false", 5) == 0) {
+		return text+5;
+	}
+	if (*text == '-' || (*text >= '0' && *text <= '9')) {
+		char* end = 0;
+		strtod(text, &end);
+		return end;
+	}
+	return 0;
+}
+
+void buffer_json_string(struct TextBuffer* text, const char* value) {
+	buffer_puts(text, "\"");
+	for (;*value;value++) {
+		if (*value == '"' || *value == '\\') {
+			buffer_printf(text, "\\%c", *value);
+		}else if ((unsigned char)*value < 0x20) {
+			buffer_printf(text, "\\u%04x", (unsigned char)*value);
+		}else{
+			buffer_write(text, value, 1);
+		}
+	}
+	buffer_puts(text, "\"");
+}
@@ -0,0 +1,265 @@
+/*
+
+	This file is part of the Malbolge disassembler.
+	Copyright (C) 2016 Matthias Lutter
+
+	The Malbolge disassembler is free software: you can redistribute it
+	and/or modify it under the terms of the GNU General Public License
+	as published by the Free Software Foundation, either version 3 of
+	the License, or (at your option) any later version.
+
+	The Malbolge disassembler is distributed in the hope that it will be
+	useful, but WITHOUT ANY WARRANTY; without even the implied warranty
+	of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+	E-Mail: matthias@lutter.cc
+
+
+
+	For more Malbolge stuff, please visit
+	<https://lutter.cc/>
+
+*/
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+#define WINDOWS
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#ifndef WINDOWS
+#include <sys/mman.h>
+#endif
+
+#include "main.h"
+
+// transcripts of the input and the output of Malbolge programs.
+// the interactive analysis saves the input of every run to a transcript file:
+//   "MDIN", TRANSCRIPT_VERSION, flags (TRANSCRIPT_*), two zero bytes,
+//   if TRANSCRIPT_OUTPUT is set: FNV-1a hash and length of the output, 8 bytes each, least significant byte first,
+//   the input.
+// any other file is taken as raw input without EOF, so input files can be written by hand.
+// input files are mapped and replayed in place; they are not copied.
+
+#define TRANSCRIPT_MAGIC "MDIN"
+#define TRANSCRIPT_VERSION 2
+#define TRANSCRIPT_HEADER_LENGTH 8
+#define TRANSCRIPT_OUTPUT_LENGTH 16
+
+static const int TRANSCRIPT_EOF    = 0x01; // the Malbolge program has read EOF after the input
+static const int TRANSCRIPT_OUTPUT = 0x02; // the Malbolge program has halted after the input; its output is recorded
+
+void put_transcript_number(unsigned char* data, unsigned long long number);
+unsigned long long get_transcript_number(const unsigned char* data);
+
+void put_transcript_number(unsigned char* data, unsigned long long number) {
+	int i;
+	for (i=0;i<8;i++) {
+		data[i] = (unsigned char)(number >> (8*i));
+	}
+}
+
+unsigned long long get_transcript_number(const unsigned char* data) {
+	unsigned long long number = 0;
+	int i;
+	for (i=0;i<8;i++) {
+		number |= (unsigned long long)data[i] << (8*i);
+	}
+	return number;
+}
+
+// returns 0 if the file has been opened, 1 if it cannot be read and 2 if it is a transcript file of an unknown version.
+int open_transcript_file(struct TranscriptFile* transcript, const char* filename) {
+	FILE* file = 0;
+	long length = 0;
+	const unsigned char* data;
+	memset(transcript, 0, sizeof(struct TranscriptFile));
+	file = fopen(filename, "rb");
+	if (!file) {
+		return 1;
+	}
+	if (fseek(file, 0, SEEK_END) != 0 || (length = ftell(file)) < 0) {
+		fclose(file);
+		return 1;
+	}
+	if (length == 0) {
+		// nothing to map
+		fclose(file);
+		return 0;
+	}
+#ifndef WINDOWS
+	transcript->mapping = mmap(0, length, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	if (transcript->mapping == MAP_FAILED) {
+		transcript->mapping = 0;
+		fclose(file);
+		return 1;
+	}
+#else
+	transcript->mapping = malloc(length);
+	if (!transcript->mapping) {
+		fclose(file);
+		return 1;
+	}
+	if (fseek(file, 0, SEEK_SET) != 0 || fread(transcript->mapping, 1, length, file) != (size_t)length) {
+		free(transcript->mapping);
+		transcript->mapping = 0;
+		fclose(file);
+		return 1;
+	}
+#endif
+	fclose(file); // the mapping stays valid
+	transcript->mapping_length = length;
+	data = (const unsigned char*)transcript->mapping;
+	if (length >= TRANSCRIPT_HEADER_LENGTH && memcmp(data, TRANSCRIPT_MAGIC, 4) == 0) {
+		int flags = data[5];
+		// version 1 has no recorded output
+		if (data[4] < 1 || data[4] > TRANSCRIPT_VERSION ||
+				((flags & TRANSCRIPT_OUTPUT) && length < TRANSCRIPT_HEADER_LENGTH+TRANSCRIPT_OUTPUT_LENGTH)) {
+			close_transcript_file(transcript);
+			return 2;
+		}
+		transcript->input.eof = (flags & TRANSCRIPT_EOF) != 0;
+		data += TRANSCRIPT_HEADER_LENGTH;
+		length -= TRANSCRIPT_HEADER_LENGTH;
+		if (flags & TRANSCRIPT_OUTPUT) {
+			transcript->has_output = 1;
+			transcript->output_hash = get_transcript_number(data);
+			transcript->output_length = get_transcript_number(data+8);
+			data += TRANSCRIPT_OUTPUT_LENGTH;
+			length -= TRANSCRIPT_OUTPUT_LENGTH;
+		}
+	}
+	// the mapping is read-only; replayed input is never written
+	transcript->input.input = (unsigned char*)data;
+	transcript->input.length = length;
+	return 0;
+}
+
+void close_transcript_file(struct TranscriptFile* transcript) {
+	if (transcript->mapping) {
+#ifndef WINDOWS
+		munmap(transcript->mapping, transcript->mapping_length);
+#else
+		free(transcript->mapping);
+#endif
+	}
+	memset(transcript, 0, sizeof(struct TranscriptFile));
+}
+
+// output is the hashed output of a run that has halted, or 0. returns 1 if the file cannot be written.
+int save_transcript_file(const char* filename, const struct UserInput* input, const struct OutputSink* output) {
+	unsigned char header[TRANSCRIPT_HEADER_LENGTH+TRANSCRIPT_OUTPUT_LENGTH] = {0};
+	size_t header_length = TRANSCRIPT_HEADER_LENGTH;
+	int failed = 0;
+	FILE* file = fopen(filename, "wb");
+	if (!file) {
+		return 1;
+	}
+	memcpy(header, TRANSCRIPT_MAGIC, 4);
+	header[4] = TRANSCRIPT_VERSION;
+	header[5] = input->eof ? TRANSCRIPT_EOF : 0;
+	if (output) {
+		header[5] |= TRANSCRIPT_OUTPUT;
+		put_transcript_number(header+TRANSCRIPT_HEADER_LENGTH, output->hash);
+		put_transcript_number(header+TRANSCRIPT_HEADER_LENGTH+8, output->length);
+		header_length += TRANSCRIPT_OUTPUT_LENGTH;
+	}
+	failed |= fwrite(header, 1, header_length, file) != header_length;
+	if (input->length > 0) {
+		failed |= fwrite(input->input, 1, input->length, file) != input->length;
+	}
+	if (fclose(file) != 0) {
+		failed = 1;
+	}
+	if (failed) {
+		remove(filename);
+	}
+	return failed;
+}
+
+// appends a character read from the terminal. the buffer grows geometrically. returns 1 if out of memory.
+int append_user_input(struct UserInput* input, unsigned char value) {
+	if (input->length == input->capacity) {
+		size_t capacity = input->capacity ? 2*input->capacity : 256;
+		unsigned char* tmp = (unsigned char*)realloc(input->input, capacity);
+		if (!tmp) {
+			return 1;
+		}
+		input->input = tmp;
+		input->capacity = capacity;
+	}
+	input->input[input->length++] = value;
+	return 0;
+}
+
+// frees recorded input; replayed input is owned by its transcript file.
+void free_user_input(struct UserInput* input) {
+	if (input->capacity && input->input) {
+		free(input->input);
+	}
+	memset(input, 0, sizeof(struct UserInput));
+}
+
+void init_output_sink(struct OutputSink* sink, int kinds) {
+	sink->kinds = kinds;
+	sink->buffered = 0;
+	memset(&sink->captured, 0, sizeof(struct UserInput));
+	sink->hash = OUTPUT_HASH_BASIS;
+	sink->length = 0;
+	sink->failed = 0;
+}
+
+// hands the buffered output to stdout
+void drain_output(struct OutputSink* sink) {
+	if (sink->buffered > 0) {
+		if (fwrite(sink->buffer, 1, sink->buffered, stdout) != sink->buffered) {
+			sink->failed = 1;
+		}
+		sink->buffered = 0;
+	}
+}
+
+void write_output(struct OutputSink* sink, unsigned char value) {
+	if (sink->kinds & OUTPUT_STDOUT) {
+		sink->buffer[sink->buffered++] = value;
+		// stdout buffers the lines itself; a terminal shows every line as soon as it is complete
+		if (value == '\n' || sink->buffered == OUTPUT_BUFFER_SIZE) {
+			drain_output(sink);
+		}
+	}
+	if ((sink->kinds & OUTPUT_CAPTURE) && append_user_input(&sink->captured, value)) {
+		sink->failed = 1;
+	}
+	if (sink->kinds & OUTPUT_HASH) {
+		sink->hash ^= value;
+		sink->hash *= 0x100000001b3ULL;
+	}
+	sink->length++;
+}
+
+// writes the buffered output, e.g. before the Malbolge program waits for input on the terminal. complete lines have
+// been handed to stdout already.
+void flush_output(struct OutputSink* sink) {
+	if ((sink->kinds & OUTPUT_STDOUT) && sink->buffered > 0) {
+		drain_output(sink);
+		if (fflush(stdout) != 0) {
+			sink->failed = 1;
+		}
+	}
+}
+
+// starts a new hash and length; the kinds and the buffers are kept.
+void restart_output_hash(struct OutputSink* sink) {
+	sink->hash = OUTPUT_HASH_BASIS;
+	sink->length = 0;
+}
+
+// frees the captured output; buffered output is not flushed.
+void free_output_sink(struct OutputSink* sink) {
+	free_user_input(&sink->captured);
+	sink->buffered = 0;
+}